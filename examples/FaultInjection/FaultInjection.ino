@@ -0,0 +1,117 @@
+/**
+ *  This example measures how the protocol stack recovers from transfer faults. For each kind of fault
+ *  it reads the certificate a number of times while faults are injected, and prints the time each read
+ *  took on top of a read without faults, the data link retransmissions and the bytes sent again.
+ *  Reads that fail are recovered with recover(), the time of the recovery is printed as well.
+ *
+ *  The fault injection has to be compiled into the library, build with -DIFX_I2C_FAULT_INJECTION=1
+ *  (e.g. build_flags in platformio.ini). The same seed injects the same faults, so runs with different
+ *  settings (e.g. DL_MAX_RETRIES) can be compared.
+ */
+#include "OPTIGATrustE.h"
+
+#define SEED            0x4F505449
+#define ROUNDS          20
+// Probability of a fault per transfer in 1/65536
+#define RATE            2000
+
+// Trust E Object
+OPTIGATrustE TrustE = OPTIGATrustE();
+
+uint8_t certificate[1024];
+
+#if IFX_I2C_FAULT_INJECTION
+const char* faultNames[IFX_I2C_FAULT_COUNT] = { "crc", "drop ack", "busy", "nack", "short read", "frame nr" };
+
+/**
+ * Reads the certificate ROUNDS times, returns the average time of a read in microseconds
+ */
+uint32_t measure(uint16_t& failures, uint32_t& recoveryTime)
+{
+    uint32_t total = 0;
+    uint32_t start;
+    uint32_t respLen = 0;
+    uint8_t  i;
+
+    failures = 0;
+    recoveryTime = 0;
+    for (i = 0; i < ROUNDS; i++)
+    {
+        start = micros();
+        if (TrustE.getCertificate(certificate, sizeof(certificate), respLen))
+        {
+            failures++;
+            start = micros();
+            TrustE.recover();
+            recoveryTime += micros() - start;
+            continue;
+        }
+        total += micros() - start;
+    }
+    return (failures < ROUNDS) ? total / (ROUNDS - failures) : 0;
+}
+#endif
+
+void setup()
+{
+    // put your setup code here, to run once:
+    Serial.begin(9600);
+
+    // starts the connection with the Optiga Trust E and opens the Optiga Trust E application. Needs to be done before carrying out any operation in the Optiga Trust E
+    if (TrustE.begin())
+    {
+        Serial.println("Error while initializing Optiga");
+    }
+}
+
+void loop()
+{
+    // put your main code here, to run repeatedly:
+#if IFX_I2C_FAULT_INJECTION
+    ifx_i2c_dl_stats_t stats;
+    uint16_t counts[IFX_I2C_FAULT_COUNT];
+    uint16_t failures;
+    uint32_t recoveryTime;
+    uint32_t baseline;
+    uint32_t average;
+    uint8_t  fault;
+
+    // Reference without faults
+    ifx_i2c_fault_init(SEED);
+    baseline = measure(failures, recoveryTime);
+    Serial.print("no faults: ");
+    Serial.print(baseline);
+    Serial.println(" us per read");
+
+    for (fault = 0; fault < IFX_I2C_FAULT_COUNT; fault++)
+    {
+        ifx_i2c_fault_init(SEED);
+        ifx_i2c_fault_set_rate(fault, RATE);
+        ifx_i2c_dl_get_stats(NULL, 1);
+
+        average = measure(failures, recoveryTime);
+
+        ifx_i2c_fault_set_rate(fault, 0);
+        ifx_i2c_fault_get_counts(counts, 1);
+        ifx_i2c_dl_get_stats(&stats, 1);
+
+        Serial.print(faultNames[fault]);
+        Serial.print(": injected ");
+        Serial.print(counts[fault]);
+        Serial.print(", ");
+        Serial.print((average > baseline) ? average - baseline : 0);
+        Serial.print(" us per read to recover, retransmissions ");
+        Serial.print(stats.retransmissions);
+        Serial.print(" (");
+        Serial.print(stats.retransmitted_bytes);
+        Serial.print(" bytes), failed reads ");
+        Serial.print(failures);
+        Serial.print(", recover() ");
+        Serial.print(failures ? recoveryTime / failures : 0);
+        Serial.println(" us");
+    }
+#else
+    Serial.println("Fault injection is not compiled in, build with -DIFX_I2C_FAULT_INJECTION=1");
+#endif
+    delay(10000);
+}
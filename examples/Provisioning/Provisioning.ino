@@ -0,0 +1,219 @@
+/**
+ *  This example provisions one Optiga Trust E on each I2C bus of the board and prints how long each stage takes.
+ *  For every chip it reads the coprocessor UID and the certificate, writes the project data object,
+ *  optionally sets the life cycle states and verifies the result.
+ *
+ *  The library keeps the state of a single session (protocol stack, frame counters, open application), so the
+ *  buses are served one after the other. begin() on a bus starts a new session and the session with the chip
+ *  provisioned before is lost: every chip is provisioned completely right after its own begin(), and end()
+ *  releases its bus before the next chip. To send further commands to a chip provisioned earlier, call begin()
+ *  on its bus again.
+ */
+#include "OPTIGATrustE.h"
+
+// Set to 1 to write the life cycle states below. Life cycle states can only be increased, this can not be undone!
+#define SET_LIFE_CYCLE_STATE    0
+#define LCSA_OPERATIONAL        0x07
+#define LCSG_OPERATIONAL        0x07
+
+// Project data object (arbitrary data object type 3)
+#define PROJECT_DATA_TAG        0xF1
+#define PROJECT_DATA_OID        0xD0
+#define PROJECT_DATA_LENGTH     64
+
+// The I2C buses with one Optiga Trust E each
+TwoWire* buses[] =
+{
+    &Wire,
+#if defined(WIRE_INTERFACES_COUNT) && WIRE_INTERFACES_COUNT > 1
+    &Wire1,
+#endif
+};
+#define BUS_COUNT               (sizeof(buses) / sizeof(buses[0]))
+
+// The stages of the provisioning of one chip
+enum
+{
+    STAGE_BEGIN,
+    STAGE_UID,
+    STAGE_CERTIFICATE,
+    STAGE_PROJECT_DATA,
+    STAGE_LIFE_CYCLE,
+    STAGE_VERIFY,
+    STAGE_COUNT
+};
+const char* stageNames[STAGE_COUNT] = { "begin", "uid", "certificate", "project data", "life cycle", "verify" };
+
+// Trust E Object
+OPTIGATrustE TrustE = OPTIGATrustE();
+
+uint8_t uid[27];
+uint8_t certificate[1024];
+uint8_t projectData[PROJECT_DATA_LENGTH];
+
+// Time spent in each stage by the current chip and by all chips
+uint32_t stageTime[STAGE_COUNT];
+uint32_t stageTotal[STAGE_COUNT];
+uint16_t provisioned = 0;
+uint16_t failed = 0;
+
+/**
+ * Runs the stages after begin for the chip on the current bus, returns the stage that failed or STAGE_COUNT
+ */
+uint8_t provision(void)
+{
+    uint32_t start;
+    uint32_t respLen = 0;
+    uint32_t offset = 0;
+
+    start = micros();
+    if (TrustE.getCoprocessorId(uid, respLen) || respLen != sizeof(uid))
+    {
+        return STAGE_UID;
+    }
+    stageTime[STAGE_UID] = micros() - start;
+
+    start = micros();
+    if (TrustE.getCertificate(certificate, sizeof(certificate), respLen))
+    {
+        return STAGE_CERTIFICATE;
+    }
+    stageTime[STAGE_CERTIFICATE] = micros() - start;
+
+    // The project data of this example starts with the UID of the chip
+    start = micros();
+    memset(projectData, 0, sizeof(projectData));
+    memcpy(projectData, uid, sizeof(uid));
+    if (TrustE.writeObject(PROJECT_DATA_TAG, PROJECT_DATA_OID, projectData, sizeof(projectData), offset))
+    {
+        return STAGE_PROJECT_DATA;
+    }
+    stageTime[STAGE_PROJECT_DATA] = micros() - start;
+
+    // The life cycle states are staged in the configuration shadow and written together
+    start = micros();
+    if (TrustE.loadConfig())
+    {
+        return STAGE_LIFE_CYCLE;
+    }
+#if SET_LIFE_CYCLE_STATE
+    uint8_t lcs = LCSA_OPERATIONAL;
+    TrustE.setLcsa(&lcs);
+    lcs = LCSG_OPERATIONAL;
+    TrustE.setLcsg(&lcs);
+#endif
+    if (TrustE.commitConfig())
+    {
+        TrustE.releaseConfig();
+        return STAGE_LIFE_CYCLE;
+    }
+    TrustE.releaseConfig();
+    stageTime[STAGE_LIFE_CYCLE] = micros() - start;
+
+    // The certificate buffer is no longer needed and holds the data read back
+    start = micros();
+    if (TrustE.readObject(PROJECT_DATA_TAG, PROJECT_DATA_OID, 0, sizeof(projectData), certificate, respLen)
+        || respLen != sizeof(projectData) || memcmp(certificate, projectData, sizeof(projectData)) != 0)
+    {
+        return STAGE_VERIFY;
+    }
+#if SET_LIFE_CYCLE_STATE
+    uint8_t state[1];
+    if (TrustE.getLcsa(state, respLen) || state[0] != LCSA_OPERATIONAL
+        || TrustE.getLcsg(state, respLen) || state[0] != LCSG_OPERATIONAL)
+    {
+        return STAGE_VERIFY;
+    }
+#endif
+    stageTime[STAGE_VERIFY] = micros() - start;
+
+    return STAGE_COUNT;
+}
+
+/**
+ * Prints the result and the stage timing of the chip on a bus
+ */
+void report(uint8_t bus, uint8_t result)
+{
+    uint8_t i;
+
+    Serial.print("bus ");
+    Serial.print(bus);
+    if (result != STAGE_COUNT)
+    {
+        Serial.print(": failed in stage ");
+        Serial.println(stageNames[result]);
+        failed++;
+        return;
+    }
+
+    Serial.print(": provisioned chip ");
+    for (i = 0; i < sizeof(uid); i++)
+    {
+        if (uid[i] < 0x10)
+        {
+            Serial.print("0");
+        }
+        Serial.print(uid[i], HEX);
+    }
+    Serial.println();
+    for (i = 0; i < STAGE_COUNT; i++)
+    {
+        Serial.print("  ");
+        Serial.print(stageNames[i]);
+        Serial.print(": ");
+        Serial.print(stageTime[i]);
+        Serial.println(" us");
+        stageTotal[i] += stageTime[i];
+    }
+    provisioned++;
+}
+
+void setup()
+{
+    // put your setup code here, to run once:
+    Serial.begin(9600);
+}
+
+void loop()
+{
+    // put your main code here, to run repeatedly:
+    uint8_t bus;
+    uint8_t i;
+    uint8_t result;
+    OPTIGATrustEBootTiming bootTiming;
+
+    for (bus = 0; bus < BUS_COUNT; bus++)
+    {
+        memset(stageTime, 0, sizeof(stageTime));
+
+        // Starts the session with the chip on this bus, the session with the chip on the previous bus is lost
+        result = STAGE_BEGIN;
+        if (TrustE.begin(*buses[bus]) == 0)
+        {
+            TrustE.getBootTiming(bootTiming);
+            stageTime[STAGE_BEGIN] = bootTiming.total_us;
+            result = provision();
+        }
+        report(bus, result);
+
+        // The chip is not addressed again before the next begin() on its bus
+        TrustE.end();
+    }
+
+    Serial.print("provisioned ");
+    Serial.print(provisioned);
+    Serial.print(", failed ");
+    Serial.println(failed);
+    for (i = 0; i < STAGE_COUNT && provisioned > 0; i++)
+    {
+        Serial.print("  average ");
+        Serial.print(stageNames[i]);
+        Serial.print(": ");
+        Serial.print(stageTotal[i] / provisioned);
+        Serial.println(" us");
+    }
+
+    // Swap the chips and provision the next set
+    delay(10000);
+}
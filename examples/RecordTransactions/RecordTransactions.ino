@@ -0,0 +1,76 @@
+/**
+ *  This example records the I2C transactions of a few commands and prints the log to the serial port.
+ *  The log can be replayed on a host without the device by extras/replay, e.g. to check that a changed
+ *  protocol stack still issues the same transactions and to measure its CPU time.
+ *
+ *  Recording has to be compiled into the library, build with -DIFX_I2C_RECORD=1 (e.g. build_flags in
+ *  platformio.ini). Save the serial output to a file and run "replay <file>" on the host, only the lines
+ *  starting with "LOG:" are read.
+ */
+#include "OPTIGATrustE.h"
+
+// Trust E Object
+OPTIGATrustE TrustE = OPTIGATrustE();
+
+uint8_t buffer[1024];
+
+#if IFX_I2C_RECORD
+/**
+ * Writer of the log, called by the library with each piece of the log
+ */
+void printLog(const uint8_t* data, uint16_t length)
+{
+    uint16_t i;
+
+    Serial.print("LOG:");
+    for (i = 0; i < length; i++)
+    {
+        if (data[i] < 0x10)
+        {
+            Serial.print("0");
+        }
+        Serial.print(data[i], HEX);
+    }
+    Serial.println();
+}
+#endif
+
+void setup()
+{
+    // put your setup code here, to run once:
+    Serial.begin(115200);
+
+#if IFX_I2C_RECORD
+    uint8_t  message[16] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                             0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F };
+    uint32_t length = 0;
+
+    // Started before begin(), so the log starts with the soft reset of the device
+    ifx_i2c_record_start(printLog);
+
+    // starts the connection with the Optiga Trust E and opens the Optiga Trust E application. Needs to be done before carrying out any operation in the Optiga Trust E
+    if (TrustE.begin())
+    {
+        ifx_i2c_record_stop();
+        Serial.println("Error while initializing Optiga");
+        return;
+    }
+    if (TrustE.getCoprocessorId(buffer, length)
+        || TrustE.getCertificate(buffer, sizeof(buffer), length)
+        || TrustE.getRandom(32, buffer)
+        || TrustE.getSignature(message, sizeof(message), buffer, length))
+    {
+        Serial.println("Error while running the commands, the log ends here");
+    }
+
+    ifx_i2c_record_stop();
+    Serial.println("Recording done");
+#else
+    Serial.println("Recording is not compiled in, build with -DIFX_I2C_RECORD=1");
+#endif
+}
+
+void loop()
+{
+    // put your main code here, to run repeatedly:
+}
@@ -0,0 +1,282 @@
+/**
+ *  This example lets several programs on a host share one Optiga Trust E. The board owns the chip and serves
+ *  requests received over the serial port with a compact binary protocol, so only one program on the host
+ *  (e.g. a daemon forwarding the requests of its clients) opens the port.
+ *
+ *  Request:  command (1 byte), request id (1 byte), payload length (1 byte), payload
+ *  Response: status (1 byte), request id (1 byte), payload length (2 bytes, big endian), payload
+ *
+ *  - Random requests are served from a pool, one command of the chip fills it for many requests.
+ *  - Signatures are queued and answered once they are done, other requests are answered meanwhile.
+ *    Responses can therefore arrive in a different order than the requests, the request id matches them.
+ *  - The certificate and the coprocessor UID are read once and answered from the cache.
+ */
+#include "OPTIGATrustE.h"
+
+// Commands
+#define CMD_RANDOM          0x01    // Payload: number of random bytes (1 byte, 1 to 255)
+#define CMD_SIGNATURE       0x02    // Payload: message (16 bytes), response: signature in DER format
+#define CMD_CERTIFICATE     0x03
+#define CMD_UID             0x04
+#define CMD_STATS           0x05    // Response: the counters of BridgeStats, 4 bytes each, big endian
+
+// Response status
+#define STATUS_OK           0x00
+#define STATUS_ERROR        0x01    // The command failed on the chip
+#define STATUS_BUSY         0x02    // Too many signatures pending, try again
+#define STATUS_INVALID      0x03    // Unknown command or invalid payload
+
+#define MAX_PAYLOAD         16
+#define POOL_SIZE           256
+// Signatures pending at a time, the command queue of the library holds 4 commands by default
+#define SIGNATURE_SLOTS     4
+
+// Trust E Object
+OPTIGATrustE TrustE = OPTIGATrustE();
+
+// Request being received, the payload of a request longer than MAX_PAYLOAD is not stored
+uint8_t  request[3 + MAX_PAYLOAD];
+uint8_t  headerLength = 0;
+uint16_t payloadLeft = 0;
+
+// Random bytes not handed out yet, each byte is used once
+uint8_t  pool[POOL_SIZE];
+uint16_t poolLeft = 0;
+
+// Cache
+uint8_t  certificate[1024];
+uint32_t certificateLength = 0;
+uint8_t  uid[27];
+uint32_t uidLength = 0;
+
+// Signatures waiting for the chip
+struct SignatureSlot
+{
+    bool    used;
+    uint8_t id;
+    uint8_t signature[72];
+};
+SignatureSlot slots[SIGNATURE_SLOTS];
+
+struct BridgeStats
+{
+    uint32_t requests;          // Requests received
+    uint32_t randomCommands;    // Random commands sent to the chip
+    uint32_t randomRequests;    // Random requests served from the pool
+    uint32_t cacheHits;         // Certificate and UID requests served from the cache
+    uint32_t signatures;        // Signatures completed
+} stats;
+
+void sendResponse(uint8_t status, uint8_t id, const uint8_t* payload, uint16_t length)
+{
+    uint8_t header[4] = { status, id, (uint8_t)(length >> 8), (uint8_t)length };
+
+    Serial.write(header, sizeof(header));
+    if (length)
+    {
+        Serial.write(payload, length);
+    }
+}
+
+/**
+ * Called by the library once a queued signature is done
+ */
+void signatureDone(uint16_t status, uint32_t length, void* context)
+{
+    SignatureSlot* slot = (SignatureSlot*)context;
+
+    if (status == 0)
+    {
+        stats.signatures++;
+        sendResponse(STATUS_OK, slot->id, slot->signature, length);
+    }
+    else
+    {
+        sendResponse(STATUS_ERROR, slot->id, NULL, 0);
+    }
+    slot->used = false;
+}
+
+void serveRandom(uint8_t id, uint8_t count)
+{
+    if (count == 0)
+    {
+        sendResponse(STATUS_INVALID, id, NULL, 0);
+        return;
+    }
+
+    // One command for the whole pool instead of one per request
+    if (poolLeft < count)
+    {
+        stats.randomCommands++;
+        if (TrustE.getRandom(POOL_SIZE, pool))
+        {
+            poolLeft = 0;
+            sendResponse(STATUS_ERROR, id, NULL, 0);
+            return;
+        }
+        poolLeft = POOL_SIZE;
+    }
+
+    stats.randomRequests++;
+    poolLeft -= count;
+    sendResponse(STATUS_OK, id, pool + poolLeft, count);
+    // The bytes are handed out once only
+    memset(pool + poolLeft, 0, count);
+}
+
+void serveSignature(uint8_t id, uint8_t* message, uint8_t length)
+{
+    uint8_t i;
+
+    if (length != 16)
+    {
+        sendResponse(STATUS_INVALID, id, NULL, 0);
+        return;
+    }
+    for (i = 0; i < SIGNATURE_SLOTS; i++)
+    {
+        if (!slots[i].used)
+        {
+            break;
+        }
+    }
+    if (i == SIGNATURE_SLOTS
+        || TrustE.queueSignature(OPTIGA_PRIORITY_HIGH, message, length, slots[i].signature,
+                                 sizeof(slots[i].signature), signatureDone, &slots[i]))
+    {
+        sendResponse(STATUS_BUSY, id, NULL, 0);
+        return;
+    }
+    slots[i].used = true;
+    slots[i].id = id;
+}
+
+void serveStats(uint8_t id)
+{
+    uint32_t counters[] = { stats.requests, stats.randomCommands, stats.randomRequests, stats.cacheHits, stats.signatures };
+    uint8_t  payload[sizeof(counters)];
+    uint8_t  i;
+
+    for (i = 0; i < sizeof(counters) / sizeof(counters[0]); i++)
+    {
+        payload[4 * i]     = counters[i] >> 24;
+        payload[4 * i + 1] = counters[i] >> 16;
+        payload[4 * i + 2] = counters[i] >> 8;
+        payload[4 * i + 3] = counters[i];
+    }
+    sendResponse(STATUS_OK, id, payload, sizeof(payload));
+}
+
+void serveRequest(void)
+{
+    uint8_t command = request[0];
+    uint8_t id = request[1];
+    uint8_t length = request[2];
+
+    stats.requests++;
+    if (length > MAX_PAYLOAD)
+    {
+        sendResponse(STATUS_INVALID, id, NULL, 0);
+        return;
+    }
+
+    switch (command)
+    {
+        case CMD_RANDOM:
+            serveRandom(id, (length == 1) ? request[3] : 0);
+            break;
+        case CMD_SIGNATURE:
+            serveSignature(id, request + 3, length);
+            break;
+        case CMD_CERTIFICATE:
+            stats.cacheHits++;
+            sendResponse(certificateLength ? STATUS_OK : STATUS_ERROR, id, certificate, certificateLength);
+            break;
+        case CMD_UID:
+            stats.cacheHits++;
+            sendResponse(uidLength ? STATUS_OK : STATUS_ERROR, id, uid, uidLength);
+            break;
+        case CMD_STATS:
+            serveStats(id);
+            break;
+        default:
+            sendResponse(STATUS_INVALID, id, NULL, 0);
+            break;
+    }
+}
+
+/**
+ * Collects a request byte by byte, returns true once it is complete. The payload of a request
+ * longer than MAX_PAYLOAD is drained without storing it, the request is answered as invalid.
+ */
+bool receive(uint8_t data)
+{
+    if (headerLength < 3)
+    {
+        request[headerLength++] = data;
+        if (headerLength < 3)
+        {
+            return false;
+        }
+        payloadLeft = request[2];
+    }
+    else
+    {
+        if (request[2] <= MAX_PAYLOAD)
+        {
+            request[3 + request[2] - payloadLeft] = data;
+        }
+        payloadLeft--;
+    }
+
+    if (payloadLeft)
+    {
+        return false;
+    }
+    headerLength = 0;
+    return true;
+}
+
+void setup()
+{
+    // put your setup code here, to run once:
+    Serial.begin(115200);
+
+    // starts the connection with the Optiga Trust E and opens the Optiga Trust E application. Needs to be done before carrying out any operation in the Optiga Trust E
+    if (TrustE.begin())
+    {
+        return;
+    }
+
+    // Selected once, the queued signatures use it
+    if (TrustE.setAuthScheme())
+    {
+        return;
+    }
+
+    // The certificate and the UID do not change, read them once
+    if (TrustE.getCertificate(certificate, sizeof(certificate), certificateLength))
+    {
+        certificateLength = 0;
+    }
+    if (TrustE.getCoprocessorId(uid, uidLength) || uidLength != sizeof(uid))
+    {
+        uidLength = 0;
+    }
+}
+
+void loop()
+{
+    // put your main code here, to run repeatedly:
+    while (Serial.available())
+    {
+        if (receive(Serial.read()))
+        {
+            serveRequest();
+        }
+    }
+
+    // Sends the queued signatures and calls signatureDone
+    TrustE.poll();
+}
@@ -46,7 +46,7 @@ void loop()
         {
 
             // gets the certificate
-            actionSuccess = TrustE.getCertificate(respBuff, respLen);
+            actionSuccess = TrustE.getCertificate(respBuff, sizeof(respBuff), respLen);
 
             // if the certificate has been successfully gotten.
             if (actionSuccess == 0)
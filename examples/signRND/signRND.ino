@@ -89,8 +89,9 @@ void loop()
                 Serial.println("Error while setting authentication scheme");
             }
 
-            //buffer where the signature will be stored. The length of the signature is 64.
-            uint8_t finalSign[64];
+            //buffer where the signature will be stored. The signature is DER encoded and up to 72 bytes long.
+            //getSignatureRaw returns r and s instead (64 bytes).
+            uint8_t finalSign[72];
             //where the length of the signature will be stored
             uint32_t signLen = 0;
 
@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// IFX I2C Protocol Stack - Replay of a recorded log on a host (source file)
+//
+// Runs the transport, data link and physical layer over a log recorded with IFX_I2C_RECORD, e.g. by the
+// RecordTransactions example, using the replay HAL instead of the device. The command APDUs are taken
+// from the writes of the log, so every log of commands sent after a begin() or reset() can be replayed.
+// Logs of a recovery (resync of the frame counters) can not be replayed this way.
+//
+// Build with make, run with: ./replay <log>
+// The log is either binary or the text printed by the example, only the lines starting with "LOG:" are read.
+// The exit code is 0 if the stack issued exactly the transactions of the log.
+
+#include "ifx_i2c_transport_layer.h"
+#include "ifx_i2c_record.h"
+#include "ifx_i2c_event.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Frames written to the data register, see ifx_i2c_data_link_layer.c and ifx_i2c_transport_layer.c
+#define REPLAY_REG_DATA             0x80
+#define REPLAY_FRAME_HEADER_LEN     3
+#define REPLAY_FRAME_CRC_LEN        2
+#define REPLAY_FCTR_CONTROL_FRAME   0x80
+#define REPLAY_FCTR_FRNR_MASK       0x0C
+#define REPLAY_PCTR_CHAINING_MASK   0x07
+#define REPLAY_CHAINING_NO          0x00
+#define REPLAY_CHAINING_LAST        0x04
+
+// Upper bound of event dispatches per command, the replay HAL completes every transfer within one
+#define REPLAY_MAX_DISPATCH         1000000
+
+// Command APDU of the log
+typedef struct
+{
+    const uint8_t* data;
+    uint16_t       length;
+    uint8_t        reset;       // The stack was initialized before the command
+} replay_apdu_t;
+
+static uint8_t  m_done;
+static uint8_t  m_event;
+static uint32_t m_response_len;
+
+void ifx_debug_log(uint8_t log_id, char * format_msg, ...)
+{
+    va_list args;
+
+    fprintf(stderr, "[%u] ", log_id);
+    va_start(args, format_msg);
+    vfprintf(stderr, format_msg, args);
+    va_end(args);
+}
+
+static void replay_event_handler(uint8_t event, uint8_t* data, uint16_t data_len)
+{
+    (void)data;
+    if (event == IFX_I2C_TL_EVENT_RX_FRAGMENT)
+    {
+        return;
+    }
+    m_event = event;
+    m_response_len = data_len;
+    m_done = 1;
+}
+
+static int replay_hex(int c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Reads a binary log or the "LOG:" lines of a text log, returns the length of the log
+static uint32_t replay_load(const char* path, uint8_t** log)
+{
+    FILE*    file = fopen(path, "rb");
+    uint8_t* data;
+    long     size;
+    uint32_t length = 0;
+    long     i;
+    uint8_t  in_log = 0;
+    uint8_t  line_start = 1;
+
+    if (file == NULL || fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) <= 0)
+    {
+        return 0;
+    }
+    rewind(file);
+    data = (uint8_t*)malloc(size);
+    if (data == NULL || fread(data, 1, size, file) != (size_t)size)
+    {
+        fclose(file);
+        return 0;
+    }
+    fclose(file);
+
+    *log = data;
+    if (size >= 4 && memcmp(data, IFX_I2C_RECORD_MAGIC, 4) == 0)
+    {
+        return (uint32_t)size;
+    }
+
+    // Decoded in place, the log is shorter than its text
+    for (i = 0; i < size; i++)
+    {
+        if (line_start)
+        {
+            in_log = (size - i >= 4 && memcmp(data + i, "LOG:", 4) == 0);
+            if (in_log)
+            {
+                i += 3;
+            }
+            line_start = 0;
+            continue;
+        }
+        if (data[i] == '\n')
+        {
+            line_start = 1;
+        }
+        else if (in_log && i + 1 < size && replay_hex(data[i]) >= 0 && replay_hex(data[i + 1]) >= 0)
+        {
+            data[length++] = (uint8_t)((replay_hex(data[i]) << 4) | replay_hex(data[i + 1]));
+            i++;
+        }
+    }
+    return length;
+}
+
+static uint8_t replay_varint(const uint8_t* log, uint32_t length, uint32_t* pos, uint32_t* value)
+{
+    uint8_t shift = 0;
+    uint8_t byte;
+
+    *value = 0;
+    do
+    {
+        if (*pos >= length || shift > 28)
+        {
+            return 0;
+        }
+        byte = log[(*pos)++];
+        *value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return 1;
+}
+
+// Reassembles the command APDUs from the frames written to the device, returns their number.
+// A frame sent again (same frame number as the frame before) is a retransmission and skipped.
+static uint32_t replay_extract(const uint8_t* log, uint32_t length, uint8_t* buffer, replay_apdu_t* apdus)
+{
+    uint32_t pos = IFX_I2C_RECORD_HEADER_LEN;
+    uint32_t count = 0;
+    uint32_t gap;
+    uint32_t record_len;
+    uint16_t frame_len;
+    uint16_t apdu_len = 0;
+    uint8_t* apdu = buffer;
+    uint8_t  type;
+    uint8_t  reset = 0;
+    int      last_frnr = -1;
+    const uint8_t* frame;
+
+    while (pos < length)
+    {
+        type = log[pos++];
+        if (!replay_varint(log, length, &pos, &gap) || !replay_varint(log, length, &pos, &record_len)
+            || record_len > length - pos)
+        {
+            break;
+        }
+        frame = log + pos + 1;
+        pos += record_len;
+
+        if (type & IFX_I2C_RECORD_RESET)
+        {
+            reset = 1;
+            last_frnr = -1;
+            apdu_len = 0;
+            continue;
+        }
+        if ((type & (IFX_I2C_RECORD_READ | IFX_I2C_RECORD_ERROR))
+            || record_len < 1 + REPLAY_FRAME_HEADER_LEN + 1 + REPLAY_FRAME_CRC_LEN
+            || frame[-1] != REPLAY_REG_DATA || (frame[0] & REPLAY_FCTR_CONTROL_FRAME))
+        {
+            continue;
+        }
+        frame_len = (frame[1] << 8) | frame[2];
+        if (frame_len == 0 || (uint32_t)(REPLAY_FRAME_HEADER_LEN + frame_len + REPLAY_FRAME_CRC_LEN) != record_len - 1
+            || (frame[0] & REPLAY_FCTR_FRNR_MASK) == last_frnr)
+        {
+            continue;
+        }
+        last_frnr = frame[0] & REPLAY_FCTR_FRNR_MASK;
+
+        // Transport layer packet: PCTR, fragment of the APDU
+        memcpy(apdu + apdu_len, frame + REPLAY_FRAME_HEADER_LEN + 1, frame_len - 1);
+        apdu_len += frame_len - 1;
+        type = frame[REPLAY_FRAME_HEADER_LEN] & REPLAY_PCTR_CHAINING_MASK;
+        if (type == REPLAY_CHAINING_NO || type == REPLAY_CHAINING_LAST)
+        {
+            apdus[count].data = apdu;
+            apdus[count].length = apdu_len;
+            apdus[count].reset = reset;
+            count++;
+            apdu += apdu_len;
+            apdu_len = 0;
+            reset = 0;
+        }
+    }
+    return count;
+}
+
+int main(int argc, char* argv[])
+{
+    uint8_t*       log = NULL;
+    uint8_t*       buffer;
+    replay_apdu_t* apdus;
+    uint32_t       length;
+    uint32_t       count;
+    uint32_t       i;
+    uint32_t       loops;
+    uint32_t       failed = 0;
+    clock_t        start;
+    ifx_i2c_replay_stats_t stats;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s <log>\n", argv[0]);
+        return 2;
+    }
+    length = replay_load(argv[1], &log);
+    buffer = (uint8_t*)malloc(length + 1);
+    apdus = (replay_apdu_t*)malloc((length + 1) * sizeof(replay_apdu_t));
+    if (length == 0 || buffer == NULL || apdus == NULL || ifx_i2c_replay_start(log, length) != IFX_I2C_STACK_SUCCESS)
+    {
+        fprintf(stderr, "%s: no valid log\n", argv[1]);
+        return 2;
+    }
+    count = replay_extract(log, length, buffer, apdus);
+    printf("log: %u bytes, %u commands\n", (unsigned)length, (unsigned)count);
+
+    start = clock();
+    for (i = 0; i < count; i++)
+    {
+        if (apdus[i].reset && ifx_i2c_tl_init(replay_event_handler) != IFX_I2C_STACK_SUCCESS)
+        {
+            printf("initialization before command %u failed\n", (unsigned)i);
+            failed++;
+            break;
+        }
+
+        m_done = 0;
+        if (ifx_i2c_tl_transceive(apdus[i].data, apdus[i].length) != IFX_I2C_STACK_SUCCESS)
+        {
+            printf("command %u: not sent\n", (unsigned)i);
+            failed++;
+            break;
+        }
+        for (loops = 0; !m_done && loops < REPLAY_MAX_DISPATCH; loops++)
+        {
+            ifx_i2c_event_dispatch();
+        }
+        printf("command %u: %02X, %u bytes, response %s, %u bytes\n", (unsigned)i, apdus[i].data[0],
+               apdus[i].length, (m_done && m_event == IFX_I2C_TL_EVENT_SUCCESS) ? "ok" : "failed",
+               (unsigned)m_response_len);
+        if (!m_done || m_event != IFX_I2C_TL_EVENT_SUCCESS)
+        {
+            failed++;
+        }
+    }
+
+    ifx_i2c_replay_get_stats(&stats);
+    printf("transactions %u, mismatches %u (first %u), bytes not replayed %u\n", (unsigned)stats.transactions,
+           (unsigned)stats.mismatches, (unsigned)stats.first_mismatch, (unsigned)stats.remaining);
+    printf("time on the recording host %u us, CPU time of the replay %u us\n", (unsigned)stats.recorded_us,
+           (unsigned)((clock() - start) * 1000000.0 / CLOCKS_PER_SEC));
+
+    return (failed || stats.mismatches || stats.remaining) ? 1 : 0;
+}
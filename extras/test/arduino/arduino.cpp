@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Host version of the Arduino core functions and the Wire library, the Wire is connected to the simulated device
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "sim_device.h"
+
+// Microseconds a call of micros() takes
+#define ARDUINO_MICROS_STEP     1
+
+static unsigned long m_micros;
+
+TwoWire Wire;
+
+unsigned long micros(void)
+{
+    m_micros += ARDUINO_MICROS_STEP;
+    return m_micros;
+}
+
+unsigned long millis(void)
+{
+    return micros() / 1000;
+}
+
+void delay(unsigned long ms)
+{
+    m_micros += ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    m_micros += us;
+}
+
+void noInterrupts(void)
+{
+}
+
+void interrupts(void)
+{
+}
+
+void TwoWire::begin(void)
+{
+    m_length = 0;
+    m_position = 0;
+}
+
+void TwoWire::setClock(uint32_t clock)
+{
+    (void)clock;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    (void)address;
+    m_length = 0;
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+    return write(&data, 1);
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t length)
+{
+    if (length > (size_t)(BUFFER_LENGTH - m_length))
+    {
+        length = BUFFER_LENGTH - m_length;
+    }
+    memcpy(m_buffer + m_length, data, length);
+    m_length += length;
+    return length;
+}
+
+// Returns 2 (address not acknowledged) like the AVR core
+uint8_t TwoWire::endTransmission(uint8_t sendStop)
+{
+    (void)sendStop;
+    return (sim_i2c_write(m_buffer, m_length) == 0) ? 0 : 2;
+}
+
+uint8_t TwoWire::endTransmission(void)
+{
+    return endTransmission(1);
+}
+
+uint8_t TwoWire::requestFrom(int address, int quantity, int sendStop)
+{
+    int count;
+
+    (void)address;
+    (void)sendStop;
+    if (quantity > BUFFER_LENGTH)
+    {
+        quantity = BUFFER_LENGTH;
+    }
+    count = sim_i2c_read(m_buffer, quantity);
+    m_length = (count > 0) ? count : 0;
+    m_position = 0;
+    return m_length;
+}
+
+int TwoWire::available(void)
+{
+    return m_length - m_position;
+}
+
+int TwoWire::read(void)
+{
+    return (m_position < m_length) ? m_buffer[m_position++] : -1;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// IFX I2C Protocol Stack - Protocol stack on the host for the tests (source file)
+
+#include "host_stack.h"
+#include "ifx_i2c_event.h"
+#include "sim_device.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <time.h>
+
+// File descriptor handed to the HAL for the simulated bus
+#define HOST_FD                 42
+// A command taking longer than this has hung
+#define HOST_TIMEOUT_MS         5000
+#define HOST_STREAM_SIZE        2048
+
+const uint8_t host_open_application[20] = {0xF0, 0x00, 0x00, 0x10, 0xD2, 0x76, 0x00, 0x00, 0x04, 0x47,
+                                           0x65, 0x6E, 0x41, 0x75, 0x74, 0x68, 0x41, 0x70, 0x70, 0x6C};
+const uint8_t host_get_certificate[6] = {0x01, 0x00, 0x00, 0x02, 0xE0, 0xE0};
+const uint8_t host_get_uid[6] = {0x01, 0x00, 0x00, 0x02, 0xE0, 0xC2};
+
+const uint8_t* host_response;
+uint16_t host_response_len;
+uint16_t host_fragments;
+
+static volatile uint8_t m_done;
+static uint8_t  m_event;
+static uint8_t  m_stream[HOST_STREAM_SIZE];
+static uint16_t m_stream_len;
+
+int __wrap_open(const char* path, int flags, ...)
+{
+    (void)path;
+    (void)flags;
+    return HOST_FD;
+}
+
+int __wrap_ioctl(int fd, unsigned long request, ...)
+{
+    (void)request;
+    return (fd == HOST_FD) ? 0 : -1;
+}
+
+ssize_t __wrap_write(int fd, const void* data, size_t length)
+{
+    if (fd != HOST_FD || sim_i2c_write((const uint8_t*)data, length) != 0)
+    {
+        return -1;
+    }
+    return (ssize_t)length;
+}
+
+ssize_t __wrap_read(int fd, void* data, size_t length)
+{
+    return (fd == HOST_FD) ? sim_i2c_read((uint8_t*)data, length) : -1;
+}
+
+static void host_event_handler(uint8_t event, uint8_t* data, uint16_t data_len)
+{
+    if (event == IFX_I2C_TL_EVENT_RX_FRAGMENT)
+    {
+        if (m_stream_len + data_len <= HOST_STREAM_SIZE)
+        {
+            memcpy(m_stream + m_stream_len, data, data_len);
+        }
+        m_stream_len += data_len;
+        host_fragments++;
+        return;
+    }
+    m_event = event;
+    host_response = (data != NULL) ? data : m_stream;
+    host_response_len = data_len;
+    m_done = 1;
+}
+
+static uint32_t host_now_ms(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+
+uint16_t host_init(void)
+{
+    return ifx_i2c_tl_init(host_event_handler);
+}
+
+uint8_t host_transceive(const uint8_t* apdu, uint16_t length)
+{
+    uint32_t start = host_now_ms();
+
+    m_done = 0;
+    m_stream_len = 0;
+    host_fragments = 0;
+    host_response = NULL;
+    host_response_len = 0;
+    if (ifx_i2c_tl_transceive((uint8_t*)apdu, length) != IFX_I2C_STACK_SUCCESS)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    while (!m_done)
+    {
+        if (host_now_ms() - start > HOST_TIMEOUT_MS)
+        {
+            fprintf(stderr, "no response\n");
+            return IFX_I2C_STACK_ERROR;
+        }
+        ifx_i2c_event_dispatch();
+    }
+    return m_event;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// IFX I2C Protocol Stack - Protocol stack on the host for the tests (header file)
+//
+// The stack is built with the Linux HAL. Its i2c-dev calls are redirected to the simulated device by linking
+// with --wrap=open,--wrap=ioctl,--wrap=read,--wrap=write, so the worker thread, its timers and the retries
+// run as on a Linux board.
+
+#ifndef _HOST_STACK_H_
+#define _HOST_STACK_H_
+
+#include "ifx_i2c_transport_layer.h"
+
+// Command APDUs of the tests
+#define HOST_RESPONSE_HEADER_LEN    4
+extern const uint8_t host_open_application[20];
+extern const uint8_t host_get_certificate[6];
+extern const uint8_t host_get_uid[6];
+
+// Response of the last command, reassembled by the transport layer or from the streamed fragments
+extern const uint8_t* host_response;
+extern uint16_t host_response_len;
+// Number of fragments streamed with IFX_I2C_TL_EVENT_RX_FRAGMENT during the last command
+extern uint16_t host_fragments;
+
+// Initializes the transport layer, returns the result of ifx_i2c_tl_init
+uint16_t host_init(void);
+
+// Sends a command and dispatches the events until it ended, returns the event of the transport layer
+// (IFX_I2C_TL_EVENT_SUCCESS or IFX_I2C_TL_EVENT_ERROR), IFX_I2C_STACK_ERROR if it did not end in time
+uint8_t host_transceive(const uint8_t* apdu, uint16_t length);
+
+#endif /* _HOST_STACK_H_ */
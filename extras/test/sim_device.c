@@ -0,0 +1,644 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// IFX I2C Protocol Stack - Simulated OPTIGA Trust E for the host tests (source file)
+
+#include "sim_device.h"
+#include <string.h>
+#include <time.h>
+
+#define SIM_REG_DATA                0x80
+#define SIM_REG_DATA_REG_LEN        0x81
+#define SIM_REG_I2C_STATE           0x82
+#define SIM_REG_SOFT_RESET          0x88
+
+#define SIM_STATE_BUSY              0x80
+#define SIM_STATE_RESPONSE_READY    0x40
+#define SIM_STATE_SOFT_RESET        0x08
+
+// Frame size after a reset and largest frame size the model accepts
+#define SIM_FRAME_SIZE_DEFAULT      0x15
+#define SIM_FRAME_SIZE_MAX          0x400
+#define SIM_FRAME_HEADER_LEN        3
+#define SIM_FRAME_CRC_LEN           2
+#define SIM_FCTR_CONTROL            0x80
+#define SIM_FCTR_TYPE(fctr)         (((fctr) >> 5) & 0x03)
+#define SIM_CONTROL_NAK             0x01
+#define SIM_CONTROL_RESYNC          0x02
+
+#define SIM_PCTR_NO_CHAINING        0x00
+#define SIM_PCTR_FIRST              0x01
+#define SIM_PCTR_INTERMEDIATE       0x02
+#define SIM_PCTR_LAST               0x04
+
+#define SIM_CMD_GET_DATA_OBJECT     0x01
+#define SIM_CMD_SET_DATA_OBJECT     0x02
+#define SIM_CMD_GET_RANDOM          0x0C
+#define SIM_CMD_SET_AUTH_SCHEME     0x10
+#define SIM_CMD_SET_AUTH_MSG        0x19
+#define SIM_CMD_GET_AUTH_MSG        0x18
+#define SIM_CMD_OPEN_APPLICATION    0x70
+#define SIM_STATUS_SUCCESS          0x00
+#define SIM_STATUS_ERROR            0xFF
+
+// Reads of the I2C state register the device stays busy after a command
+#define SIM_BUSY_POLLS              2
+#define SIM_QUEUE_LEN               4
+#define SIM_OBJECT_COUNT            8
+#define SIM_OBJECT_SIZE             1728
+#define SIM_APDU_SIZE               2048
+#define SIM_SIGNATURE_LEN           70
+
+typedef struct
+{
+    uint8_t  data[SIM_FRAME_SIZE_MAX];
+    uint16_t length;
+} sim_frame_t;
+
+typedef struct
+{
+    uint16_t oid;
+    uint16_t length;
+    uint8_t  data[SIM_OBJECT_SIZE];
+} sim_object_t;
+
+static uint8_t      m_reg;
+static uint16_t     m_frame_size;
+static uint8_t      m_tx_nr;
+static uint8_t      m_rx_nr;
+static sim_frame_t  m_queue[SIM_QUEUE_LEN];
+static uint8_t      m_queue_len;
+static sim_frame_t  m_last_out;
+static uint8_t      m_apdu[SIM_APDU_SIZE];
+static uint16_t     m_apdu_len;
+static uint8_t      m_response[SIM_APDU_SIZE];
+static uint16_t     m_response_len;
+static uint16_t     m_response_pos;
+static uint8_t      m_response_pending;
+static uint8_t      m_busy_polls;
+static uint8_t      m_app_open;
+static uint8_t      m_scheme;
+static sim_object_t m_objects[SIM_OBJECT_COUNT];
+static int          m_nack;
+static uint8_t      m_nacked;
+static struct timespec m_nack_time;
+static uint32_t     m_retry_gap_us;
+static int          m_corrupt;
+static int          m_apdus;
+static int          m_soft_resets;
+
+static uint16_t sim_crc_byte(uint16_t seed, uint8_t byte)
+{
+    uint16_t h1, h2, h3, h4;
+
+    h1 = (seed ^ byte) & 0xFF;
+    h2 = h1 & 0x0F;
+    h3 = ((uint16_t)(h2 << 4)) ^ h1;
+    h4 = h3 >> 4;
+    return ((uint16_t)((((uint16_t)((((uint16_t)(h3 << 1)) ^ h4) << 4)) ^ h2) << 3)) ^ h4 ^ (seed >> 8);
+}
+
+static uint16_t sim_crc(const uint8_t* data, uint16_t length)
+{
+    uint16_t crc = 0;
+    uint16_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        crc = sim_crc_byte(crc, data[i]);
+    }
+    return crc;
+}
+
+// Called on every transfer, returns 1 if the device does not acknowledge it
+static uint8_t sim_nack_transfer(void)
+{
+    struct timespec now;
+    uint32_t gap;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (m_nacked)
+    {
+        gap = (uint32_t)((now.tv_sec - m_nack_time.tv_sec) * 1000000L + (now.tv_nsec - m_nack_time.tv_nsec) / 1000);
+        if (gap < m_retry_gap_us)
+        {
+            m_retry_gap_us = gap;
+        }
+    }
+    m_nacked = (m_nack > 0);
+    m_nack_time = now;
+    if (m_nacked)
+    {
+        m_nack--;
+    }
+    return m_nacked;
+}
+
+static sim_object_t* sim_find(uint16_t oid)
+{
+    uint8_t i;
+
+    for (i = 0; i < SIM_OBJECT_COUNT; i++)
+    {
+        if (m_objects[i].oid == oid)
+        {
+            return &m_objects[i];
+        }
+    }
+    return NULL;
+}
+
+static void sim_add(uint16_t oid, const uint8_t* data, uint16_t length)
+{
+    sim_object_t* object = sim_find(0);
+
+    object->oid = oid;
+    object->length = length;
+    memcpy(object->data, data, length);
+}
+
+// Resets the frame counters and drops the pending response
+static void sim_resync(void)
+{
+    m_tx_nr = 3;
+    m_rx_nr = 3;
+    m_queue_len = 0;
+    m_response_pending = 0;
+    m_busy_polls = 0;
+}
+
+static void sim_queue_frame(uint8_t fctr, const uint8_t* payload, uint16_t length)
+{
+    sim_frame_t* frame;
+    uint16_t crc;
+
+    if (m_queue_len == SIM_QUEUE_LEN)
+    {
+        return;
+    }
+    frame = &m_queue[m_queue_len++];
+
+    frame->data[0] = fctr;
+    frame->data[1] = (uint8_t)(length >> 8);
+    frame->data[2] = (uint8_t)length;
+    memcpy(frame->data + SIM_FRAME_HEADER_LEN, payload, length);
+    crc = sim_crc(frame->data, SIM_FRAME_HEADER_LEN + length);
+    frame->data[SIM_FRAME_HEADER_LEN + length] = (uint8_t)(crc >> 8);
+    frame->data[SIM_FRAME_HEADER_LEN + length + 1] = (uint8_t)crc;
+    frame->length = SIM_FRAME_HEADER_LEN + length + SIM_FRAME_CRC_LEN;
+}
+
+static void sim_queue_ack(void)
+{
+    sim_queue_frame((uint8_t)(SIM_FCTR_CONTROL | m_rx_nr), NULL, 0);
+}
+
+// Queues the next packet of the response, chained if it does not fit into one frame
+static void sim_queue_response_packet(void)
+{
+    uint8_t  packet[SIM_FRAME_SIZE_MAX];
+    uint16_t max_packet = m_frame_size - SIM_FRAME_HEADER_LEN - SIM_FRAME_CRC_LEN - 1;
+    uint16_t remaining = m_response_len - m_response_pos;
+    uint16_t length = (remaining < max_packet) ? remaining : max_packet;
+
+    if (m_response_pos == 0)
+    {
+        packet[0] = (remaining <= max_packet) ? SIM_PCTR_NO_CHAINING : SIM_PCTR_FIRST;
+    }
+    else
+    {
+        packet[0] = (remaining <= max_packet) ? SIM_PCTR_LAST : SIM_PCTR_INTERMEDIATE;
+    }
+    memcpy(packet + 1, m_response + m_response_pos, length);
+    m_response_pos += length;
+    m_response_pending = (m_response_pos < m_response_len);
+
+    m_tx_nr = (m_tx_nr + 1) & 0x03;
+    sim_queue_frame((uint8_t)((m_tx_nr << 2) | m_rx_nr), packet, length + 1);
+}
+
+static void sim_respond(uint8_t status, const uint8_t* data, uint16_t length)
+{
+    m_response[0] = status;
+    m_response[1] = 0;
+    m_response[2] = (uint8_t)(length >> 8);
+    m_response[3] = (uint8_t)length;
+    if (length > 0)
+    {
+        memcpy(m_response + 4, data, length);
+    }
+    m_response_len = length + 4;
+    m_response_pos = 0;
+    m_busy_polls = SIM_BUSY_POLLS;
+    sim_queue_response_packet();
+}
+
+static void sim_get_data_object(const uint8_t* data, uint16_t length)
+{
+    sim_object_t* object = sim_find((uint16_t)((data[0] << 8) | data[1]));
+    uint16_t offset = 0;
+    uint16_t count;
+
+    if (object == NULL)
+    {
+        sim_respond(SIM_STATUS_ERROR, NULL, 0);
+        return;
+    }
+    count = object->length;
+    if (length >= 6)
+    {
+        offset = (uint16_t)((data[2] << 8) | data[3]);
+        count = (uint16_t)((data[4] << 8) | data[5]);
+    }
+    if (offset > object->length)
+    {
+        sim_respond(SIM_STATUS_ERROR, NULL, 0);
+        return;
+    }
+    if (count > object->length - offset)
+    {
+        count = object->length - offset;
+    }
+    sim_respond(SIM_STATUS_SUCCESS, object->data + offset, count);
+}
+
+static void sim_set_data_object(const uint8_t* data, uint16_t length)
+{
+    uint16_t oid = (uint16_t)((data[0] << 8) | data[1]);
+    uint16_t offset = (uint16_t)((data[2] << 8) | data[3]);
+    sim_object_t* object = sim_find(oid);
+
+    if (length < 4 || offset + length - 4 > SIM_OBJECT_SIZE || (object == NULL && (object = sim_find(0)) == NULL))
+    {
+        sim_respond(SIM_STATUS_ERROR, NULL, 0);
+        return;
+    }
+    object->oid = oid;
+    memcpy(object->data + offset, data + 4, length - 4);
+    if (object->length < offset + length - 4)
+    {
+        object->length = offset + length - 4;
+    }
+    sim_respond(SIM_STATUS_SUCCESS, NULL, 0);
+}
+
+// Answers with a DER encoded ECDSA signature of two fixed 32 byte integers
+static void sim_get_auth_msg(void)
+{
+    uint8_t signature[SIM_SIGNATURE_LEN];
+
+    signature[0] = 0x30;
+    signature[1] = SIM_SIGNATURE_LEN - 2;
+    signature[2] = 0x02;
+    signature[3] = 0x20;
+    memset(signature + 4, 0x11, 0x20);
+    signature[36] = 0x02;
+    signature[37] = 0x20;
+    memset(signature + 38, 0x22, 0x20);
+    sim_respond(SIM_STATUS_SUCCESS, signature, SIM_SIGNATURE_LEN);
+}
+
+static void sim_command(void)
+{
+    uint8_t  cmd = m_apdu[0] & 0x7F;
+    uint16_t length = (uint16_t)((m_apdu[2] << 8) | m_apdu[3]);
+    const uint8_t* data = m_apdu + 4;
+    uint8_t  random[SIM_APDU_SIZE];
+    uint16_t i;
+
+    m_apdus++;
+    if (m_apdu_len < 4 || length + 4 != m_apdu_len)
+    {
+        sim_respond(SIM_STATUS_ERROR, NULL, 0);
+        return;
+    }
+    if (cmd == SIM_CMD_OPEN_APPLICATION)
+    {
+        m_app_open = 1;
+        m_scheme = 0;
+        sim_respond(SIM_STATUS_SUCCESS, NULL, 0);
+        return;
+    }
+    if (!m_app_open)
+    {
+        sim_respond(SIM_STATUS_ERROR, NULL, 0);
+        return;
+    }
+    switch (cmd)
+    {
+        case SIM_CMD_GET_DATA_OBJECT:
+            sim_get_data_object(data, length);
+            break;
+        case SIM_CMD_SET_DATA_OBJECT:
+            sim_set_data_object(data, length);
+            break;
+        case SIM_CMD_GET_RANDOM:
+            length = (uint16_t)((data[0] << 8) | data[1]);
+            for (i = 0; i < length && i < sizeof(random); i++)
+            {
+                random[i] = (uint8_t)(i * 37 + 11);
+            }
+            sim_respond(SIM_STATUS_SUCCESS, random, i);
+            break;
+        case SIM_CMD_SET_AUTH_SCHEME:
+            m_scheme = 1;
+            sim_respond(SIM_STATUS_SUCCESS, NULL, 0);
+            break;
+        case SIM_CMD_SET_AUTH_MSG:
+            sim_respond((length == 16) ? SIM_STATUS_SUCCESS : SIM_STATUS_ERROR, NULL, 0);
+            break;
+        case SIM_CMD_GET_AUTH_MSG:
+            if (m_scheme)
+            {
+                sim_get_auth_msg();
+            }
+            else
+            {
+                sim_respond(SIM_STATUS_ERROR, NULL, 0);
+            }
+            break;
+        default:
+            sim_respond(SIM_STATUS_ERROR, NULL, 0);
+            break;
+    }
+}
+
+// Repeats the frame read last in front of the queue
+static void sim_repeat(void)
+{
+    if (m_queue_len == SIM_QUEUE_LEN)
+    {
+        return;
+    }
+    memmove(&m_queue[1], &m_queue[0], m_queue_len * sizeof(sim_frame_t));
+    m_queue[0] = m_last_out;
+    m_queue_len++;
+}
+
+static void sim_frame(const uint8_t* frame, uint16_t length)
+{
+    uint16_t packet_len;
+    uint8_t  fctr = frame[0];
+    uint8_t  frame_nr;
+
+    if (length < SIM_FRAME_HEADER_LEN + SIM_FRAME_CRC_LEN)
+    {
+        return;
+    }
+    packet_len = (uint16_t)((frame[1] << 8) | frame[2]);
+    if (length != packet_len + SIM_FRAME_HEADER_LEN + SIM_FRAME_CRC_LEN
+        || sim_crc(frame, SIM_FRAME_HEADER_LEN + packet_len)
+           != ((frame[SIM_FRAME_HEADER_LEN + packet_len] << 8) | frame[SIM_FRAME_HEADER_LEN + packet_len + 1]))
+    {
+        return;
+    }
+
+    if (fctr & SIM_FCTR_CONTROL)
+    {
+        if (SIM_FCTR_TYPE(fctr) == SIM_CONTROL_RESYNC)
+        {
+            sim_resync();
+        }
+        else if (SIM_FCTR_TYPE(fctr) == SIM_CONTROL_NAK)
+        {
+            sim_repeat();
+        }
+        else if (m_response_pending)
+        {
+            sim_queue_response_packet();
+        }
+        return;
+    }
+
+    // A data frame with the number of the previous one was sent again
+    frame_nr = (fctr >> 2) & 0x03;
+    if (frame_nr == m_rx_nr)
+    {
+        if (SIM_FCTR_TYPE(fctr) == SIM_CONTROL_NAK)
+        {
+            sim_repeat();
+        }
+        return;
+    }
+    m_rx_nr = frame_nr;
+
+    if (frame[3] == SIM_PCTR_NO_CHAINING || frame[3] == SIM_PCTR_FIRST)
+    {
+        m_apdu_len = 0;
+    }
+    if (m_apdu_len + packet_len - 1 > SIM_APDU_SIZE)
+    {
+        m_apdu_len = 0;
+        return;
+    }
+    memcpy(m_apdu + m_apdu_len, frame + SIM_FRAME_HEADER_LEN + 1, packet_len - 1);
+    m_apdu_len += packet_len - 1;
+
+    if (frame[3] == SIM_PCTR_NO_CHAINING || frame[3] == SIM_PCTR_LAST)
+    {
+        sim_command();
+        m_apdu_len = 0;
+    }
+    else
+    {
+        sim_queue_ack();
+    }
+}
+
+void sim_reset(void)
+{
+    uint8_t  certificate[SIM_CERTIFICATE_LEN];
+    uint8_t  uid[SIM_UID_LEN];
+    uint8_t  byte = 0x07;
+    uint16_t i;
+
+    m_reg = 0;
+    m_frame_size = SIM_FRAME_SIZE_DEFAULT;
+    m_app_open = 0;
+    m_scheme = 0;
+    m_nack = 0;
+    m_nacked = 0;
+    m_retry_gap_us = 0xFFFFFFFF;
+    m_corrupt = 0;
+    m_apdus = 0;
+    m_soft_resets = 0;
+    m_apdu_len = 0;
+    sim_resync();
+
+    memset(m_objects, 0, sizeof(m_objects));
+    certificate[0] = 0x30;
+    certificate[1] = 0x82;
+    certificate[2] = (uint8_t)((SIM_CERTIFICATE_LEN - 4) >> 8);
+    certificate[3] = (uint8_t)(SIM_CERTIFICATE_LEN - 4);
+    for (i = 4; i < SIM_CERTIFICATE_LEN; i++)
+    {
+        certificate[i] = (uint8_t)(i * 7);
+    }
+    sim_add(SIM_OID_CERTIFICATE, certificate, SIM_CERTIFICATE_LEN);
+    for (i = 0; i < SIM_UID_LEN; i++)
+    {
+        uid[i] = (uint8_t)(0xA0 + i);
+    }
+    sim_add(SIM_OID_UID, uid, SIM_UID_LEN);
+    // Last error code, lifecycle state and security event counter
+    sim_add(0xE0C0, &byte, 1);
+    byte = 0;
+    sim_add(0xE0C1, &byte, 1);
+    byte = 0x09;
+    sim_add(0xE0C4, &byte, 1);
+}
+
+int sim_i2c_write(const uint8_t* data, size_t length)
+{
+    if (sim_nack_transfer())
+    {
+        return -1;
+    }
+    if (length == 0)
+    {
+        return 0;
+    }
+    m_reg = data[0];
+    if (length == 1)
+    {
+        return 0;
+    }
+    switch (m_reg)
+    {
+        case SIM_REG_SOFT_RESET:
+            m_soft_resets++;
+            m_app_open = 0;
+            m_frame_size = SIM_FRAME_SIZE_DEFAULT;
+            sim_resync();
+            break;
+        case SIM_REG_DATA_REG_LEN:
+            if (length >= 3)
+            {
+                m_frame_size = (uint16_t)((data[1] << 8) | data[2]);
+                if (m_frame_size > SIM_FRAME_SIZE_MAX)
+                {
+                    m_frame_size = SIM_FRAME_SIZE_MAX;
+                }
+            }
+            break;
+        case SIM_REG_DATA:
+            sim_frame(data + 1, (uint16_t)(length - 1));
+            break;
+    }
+    return 0;
+}
+
+int sim_i2c_read(uint8_t* data, size_t length)
+{
+    uint8_t  state[4] = {SIM_STATE_SOFT_RESET, 0, 0, 0};
+    uint16_t count = 0;
+
+    if (sim_nack_transfer())
+    {
+        return -1;
+    }
+    if (m_reg == SIM_REG_I2C_STATE)
+    {
+        if (m_busy_polls > 0)
+        {
+            m_busy_polls--;
+            state[0] |= SIM_STATE_BUSY;
+        }
+        else if (m_queue_len > 0)
+        {
+            state[0] |= SIM_STATE_RESPONSE_READY;
+            state[2] = (uint8_t)(m_queue[0].length >> 8);
+            state[3] = (uint8_t)m_queue[0].length;
+        }
+        count = (length < sizeof(state)) ? (uint16_t)length : sizeof(state);
+        memcpy(data, state, count);
+    }
+    else if (m_reg == SIM_REG_DATA_REG_LEN)
+    {
+        state[0] = (uint8_t)(m_frame_size >> 8);
+        state[1] = (uint8_t)m_frame_size;
+        count = (length < 2) ? (uint16_t)length : 2;
+        memcpy(data, state, count);
+    }
+    else if (m_reg == SIM_REG_DATA && m_queue_len > 0)
+    {
+        m_last_out = m_queue[0];
+        memmove(&m_queue[0], &m_queue[1], (m_queue_len - 1) * sizeof(sim_frame_t));
+        m_queue_len--;
+        count = (length < m_last_out.length) ? (uint16_t)length : m_last_out.length;
+        memcpy(data, m_last_out.data, count);
+        if (m_corrupt > 0 && count > 0)
+        {
+            m_corrupt--;
+            data[count - 1] ^= 0xFF;
+        }
+    }
+    return count;
+}
+
+void sim_nack(int count)
+{
+    m_nack = count;
+}
+
+void sim_corrupt(int count)
+{
+    m_corrupt = count;
+}
+
+uint32_t sim_retry_gap_us(void)
+{
+    return m_retry_gap_us;
+}
+
+int sim_apdu_count(void)
+{
+    return m_apdus;
+}
+
+int sim_soft_reset_count(void)
+{
+    return m_soft_resets;
+}
+
+const uint8_t* sim_object(uint16_t oid, uint16_t* length)
+{
+    sim_object_t* object = sim_find(oid);
+
+    if (object == NULL)
+    {
+        return NULL;
+    }
+    *length = object->length;
+    return object->data;
+}
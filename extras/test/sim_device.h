@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// IFX I2C Protocol Stack - Simulated OPTIGA Trust E for the host tests (header file)
+//
+// Register level model of the device: the I2C state, data register length, data and soft reset registers,
+// the data link layer frames with their CRC and frame counters, chained transport layer packets and the
+// commands the library issues. The data objects hold a 500 byte certificate, which takes several chained
+// frames to read.
+
+#ifndef _SIM_DEVICE_H_
+#define _SIM_DEVICE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Data objects of the simulated device
+#define SIM_OID_CERTIFICATE     0xE0E0
+#define SIM_OID_UID             0xE0C2
+#define SIM_CERTIFICATE_LEN     500
+#define SIM_UID_LEN             27
+
+// Puts the device into its power-on state
+void sim_reset(void);
+
+// I2C write of the host (register address followed by the data), returns 0 if acknowledged, -1 if not
+int sim_i2c_write(const uint8_t* data, size_t length);
+
+// I2C read of the host from the register written last, returns the number of bytes read, -1 if not acknowledged
+int sim_i2c_read(uint8_t* data, size_t length);
+
+// The next count transfers are not acknowledged
+void sim_nack(int count);
+
+// The next count frames read from the device carry a wrong CRC
+void sim_corrupt(int count);
+
+// Shortest time in microseconds between a transfer that was not acknowledged and the next attempt of the host
+uint32_t sim_retry_gap_us(void);
+
+// Number of command APDUs the device processed
+int sim_apdu_count(void);
+
+// Number of soft resets of the device
+int sim_soft_reset_count(void);
+
+// Content of a data object, NULL if the object does not exist
+const uint8_t* sim_object(uint16_t oid, uint16_t* length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SIM_DEVICE_H_ */
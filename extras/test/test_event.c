@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// IFX I2C Protocol Stack - Host test of the event queue (source file)
+//
+// The queue is tested on its own, ifx_i2c_hal_poll() is provided here and may post an event like a polled HAL.
+
+#include "ifx_i2c_event.h"
+#include "test.h"
+
+#define TEST_ROUNDS     (3 * IFX_I2C_EVENT_QUEUE_SIZE + 1)
+
+static uint8_t m_delivered[2 * TEST_ROUNDS];
+static uint8_t m_delivered_count;
+static uint8_t m_polls;
+static uint8_t m_post_on_poll;
+
+// Events and timers are recorded in the order of delivery, timers as 0xFF
+static void test_handler(uint8_t event)
+{
+    m_delivered[m_delivered_count++] = event;
+}
+
+static void test_timer(void)
+{
+    m_delivered[m_delivered_count++] = 0xFF;
+}
+
+// Posts the follow-up event like a layer starting its next transfer from the handler
+static void test_chained_handler(uint8_t event)
+{
+    test_handler(event);
+    if (event > 0)
+    {
+        ifx_i2c_event_post(test_chained_handler, event - 1);
+    }
+}
+
+void ifx_i2c_hal_poll(void)
+{
+    m_polls++;
+    if (m_post_on_poll)
+    {
+        m_post_on_poll = 0;
+        ifx_i2c_event_post(test_handler, IFX_I2C_HAL_RX_SUCCESS);
+    }
+}
+
+int main(void)
+{
+    ifx_i2c_event_stats_t stats;
+    uint8_t i;
+
+    ifx_i2c_event_init();
+    ifx_i2c_event_get_stats(NULL, 1);
+
+    // An empty queue lets the HAL progress and delivers what it posts right away
+    TEST_CHECK(ifx_i2c_event_dispatch() == 0);
+    TEST_CHECK(m_polls == 1);
+    m_post_on_poll = 1;
+    TEST_CHECK(ifx_i2c_event_dispatch() == 1);
+    TEST_CHECK(m_polls == 2);
+    TEST_CHECK(m_delivered_count == 1 && m_delivered[0] == IFX_I2C_HAL_RX_SUCCESS);
+
+    // Handler and callback are required
+    TEST_CHECK(ifx_i2c_event_post(NULL, IFX_I2C_HAL_TX_SUCCESS) == IFX_I2C_STACK_ERROR);
+    TEST_CHECK(ifx_i2c_event_post_timer(NULL) == IFX_I2C_STACK_ERROR);
+
+    // The queue holds IFX_I2C_EVENT_QUEUE_SIZE events, one more is counted as overflow
+    m_delivered_count = 0;
+    for (i = 0; i < IFX_I2C_EVENT_QUEUE_SIZE; i++)
+    {
+        TEST_CHECK(((i & 1) ? ifx_i2c_event_post_timer(test_timer) : ifx_i2c_event_post(test_handler, i))
+                   == IFX_I2C_STACK_SUCCESS);
+    }
+    TEST_CHECK(ifx_i2c_event_post(test_handler, 0) == IFX_I2C_STACK_ERROR);
+    ifx_i2c_event_get_stats(&stats, 0);
+    TEST_CHECK(stats.max_pending == IFX_I2C_EVENT_QUEUE_SIZE);
+    TEST_CHECK(stats.overflows == 1);
+
+    // Events and timers are delivered in the order they were posted
+    for (i = 0; i < IFX_I2C_EVENT_QUEUE_SIZE; i++)
+    {
+        TEST_CHECK(ifx_i2c_event_dispatch() == 1);
+        TEST_CHECK(m_delivered[i] == ((i & 1) ? 0xFF : i));
+    }
+    TEST_CHECK(m_delivered_count == IFX_I2C_EVENT_QUEUE_SIZE);
+
+    // The order holds while the ring wraps around several times
+    m_delivered_count = 0;
+    for (i = 0; i < TEST_ROUNDS; i++)
+    {
+        TEST_CHECK(ifx_i2c_event_post(test_handler, i) == IFX_I2C_STACK_SUCCESS);
+        if (i & 1)
+        {
+            TEST_CHECK(ifx_i2c_event_dispatch() == 1);
+            TEST_CHECK(ifx_i2c_event_dispatch() == 1);
+        }
+    }
+    while (ifx_i2c_event_dispatch())
+    {
+    }
+    TEST_CHECK(m_delivered_count == TEST_ROUNDS);
+    for (i = 0; i < TEST_ROUNDS; i++)
+    {
+        TEST_CHECK(m_delivered[i] == i);
+    }
+
+    // An event posted by a handler is delivered by the next dispatch, one event per dispatch
+    m_delivered_count = 0;
+    TEST_CHECK(ifx_i2c_event_post(test_chained_handler, 3) == IFX_I2C_STACK_SUCCESS);
+    for (i = 0; i < 4; i++)
+    {
+        TEST_CHECK(ifx_i2c_event_dispatch() == 1);
+        TEST_CHECK(m_delivered_count == i + 1 && m_delivered[i] == 3 - i);
+    }
+    TEST_CHECK(ifx_i2c_event_dispatch() == 0);
+
+    // Initializing the queue discards pending events
+    TEST_CHECK(ifx_i2c_event_post(test_handler, 0) == IFX_I2C_STACK_SUCCESS);
+    ifx_i2c_event_init();
+    m_delivered_count = 0;
+    TEST_CHECK(ifx_i2c_event_dispatch() == 0);
+    TEST_CHECK(m_delivered_count == 0);
+
+    // Reading with reset clears the statistics
+    ifx_i2c_event_get_stats(&stats, 1);
+    TEST_CHECK(stats.overflows == 1);
+    ifx_i2c_event_get_stats(&stats, 0);
+    TEST_CHECK(stats.overflows == 0 && stats.max_pending == 0);
+
+    return TEST_RESULT();
+}
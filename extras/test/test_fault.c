@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// IFX I2C Protocol Stack - Host test of the fault injection (source file)
+//
+// The same seed and rates have to inject the same faults into the same transfers, so a failing run of the
+// FaultInjection example can be repeated. The transfers are those of a command: polls of the I2C state,
+// a data frame written, a data frame read and its acknowledge.
+
+#include "ifx_i2c_fault.h"
+#include "test.h"
+#include <string.h>
+
+#define TEST_COMMANDS       200
+#define TEST_RATE           0x2000
+#define TEST_STEP_LEN       12
+#define TEST_TRACE_LEN      (TEST_COMMANDS * 5 * TEST_STEP_LEN)
+
+// Transfers of a command: register address and frame written, I2C state and frame read
+static const uint8_t m_poll[] = {0x82};
+static const uint8_t m_data_register[] = {0x80};
+static const uint8_t m_state[] = {0x08, 0x00, 0x00, 0x0A};
+static const uint8_t m_write_frame[] = {0x80, 0x04, 0x00, 0x01, 0x00, 0x43, 0x21};
+static const uint8_t m_ack_frame[] = {0x80, 0x81, 0x00, 0x00, 0x00, 0x00};
+// Data frame with 5 bytes of payload, the CRC is added by main
+static uint8_t m_read_frame[10] = {0x05, 0x00, 0x05, 0x00, 0x00, 0x04, 0x00, 0x00};
+
+static uint8_t m_trace[TEST_TRACE_LEN];
+static uint16_t m_trace_len;
+
+static uint16_t test_crc(const uint8_t* data, uint16_t length)
+{
+    uint16_t crc = 0;
+    uint16_t h1, h2, h3, h4;
+
+    while (length--)
+    {
+        h1 = (crc ^ *data++) & 0xFF;
+        h2 = h1 & 0x0F;
+        h3 = ((uint16_t)(h2 << 4)) ^ h1;
+        h4 = h3 >> 4;
+        crc = ((uint16_t)((((uint16_t)((((uint16_t)(h3 << 1)) ^ h4) << 4)) ^ h2) << 3)) ^ h4 ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static void test_write(const uint8_t* data, uint16_t length)
+{
+    m_trace[m_trace_len] = ifx_i2c_fault_transmit(data, length);
+    m_trace_len += TEST_STEP_LEN;
+}
+
+static void test_read(const uint8_t* register_address, const uint8_t* data, uint16_t length)
+{
+    uint8_t buffer[TEST_STEP_LEN - 1];
+
+    ifx_i2c_fault_transmit(register_address, 1);
+    memcpy(buffer, data, length);
+    ifx_i2c_fault_receive(buffer, &length);
+    m_trace[m_trace_len] = (uint8_t)length;
+    memcpy(m_trace + m_trace_len + 1, buffer, length);
+    m_trace_len += TEST_STEP_LEN;
+}
+
+// Runs the transfers of TEST_COMMANDS commands, the trace holds every result and every byte read
+static void test_run(uint32_t seed, uint16_t rate, uint16_t counts[IFX_I2C_FAULT_COUNT])
+{
+    uint8_t fault;
+    uint16_t i;
+
+    ifx_i2c_fault_init(seed);
+    for (fault = 0; fault < IFX_I2C_FAULT_COUNT; fault++)
+    {
+        ifx_i2c_fault_set_rate(fault, rate);
+    }
+    memset(m_trace, 0, sizeof(m_trace));
+    m_trace_len = 0;
+    for (i = 0; i < TEST_COMMANDS; i++)
+    {
+        test_write(m_write_frame, sizeof(m_write_frame));
+        test_read(m_poll, m_state, sizeof(m_state));
+        test_read(m_data_register, m_read_frame, sizeof(m_read_frame));
+        test_write(m_ack_frame, sizeof(m_ack_frame));
+        test_read(m_poll, m_state, sizeof(m_state));
+    }
+    ifx_i2c_fault_get_counts(counts, 1);
+}
+
+int main(void)
+{
+    static uint8_t first[TEST_TRACE_LEN];
+    static uint8_t unchanged[TEST_TRACE_LEN];
+    uint16_t counts[IFX_I2C_FAULT_COUNT];
+    uint16_t first_counts[IFX_I2C_FAULT_COUNT];
+    uint8_t frame[sizeof(m_read_frame)];
+    uint16_t length;
+    uint16_t crc;
+    uint8_t fault;
+    uint8_t i;
+
+    crc = test_crc(m_read_frame, sizeof(m_read_frame) - 2);
+    m_read_frame[8] = (uint8_t)(crc >> 8);
+    m_read_frame[9] = (uint8_t)crc;
+
+    // Without rates nothing is injected
+    test_run(1, 0, counts);
+    memcpy(unchanged, m_trace, sizeof(m_trace));
+    for (fault = 0; fault < IFX_I2C_FAULT_COUNT; fault++)
+    {
+        TEST_CHECK(counts[fault] == 0);
+    }
+
+    // The same seed injects the same faults, every class at least once
+    test_run(1, TEST_RATE, first_counts);
+    memcpy(first, m_trace, sizeof(m_trace));
+    test_run(1, TEST_RATE, counts);
+    TEST_CHECK(memcmp(first, m_trace, sizeof(m_trace)) == 0);
+    TEST_CHECK(memcmp(first_counts, counts, sizeof(counts)) == 0);
+    TEST_CHECK(memcmp(first, unchanged, sizeof(m_trace)) != 0);
+    for (fault = 0; fault < IFX_I2C_FAULT_COUNT; fault++)
+    {
+        TEST_CHECK(first_counts[fault] > 0);
+    }
+
+    // Another seed injects other faults, seed 0 is the same as seed 1
+    test_run(2, TEST_RATE, counts);
+    TEST_CHECK(memcmp(first, m_trace, sizeof(m_trace)) != 0);
+    test_run(0, TEST_RATE, counts);
+    TEST_CHECK(memcmp(first, m_trace, sizeof(m_trace)) == 0);
+
+    // A changed frame number comes with a valid CRC
+    ifx_i2c_fault_init(1);
+    ifx_i2c_fault_set_rate(IFX_I2C_FAULT_FRAME_NR, 0xFFFF);
+    memcpy(frame, m_read_frame, sizeof(frame));
+    length = sizeof(frame);
+    ifx_i2c_fault_transmit(m_data_register, sizeof(m_data_register));
+    ifx_i2c_fault_receive(frame, &length);
+    TEST_CHECK(length == sizeof(frame));
+    TEST_CHECK((frame[0] & 0x0C) != (m_read_frame[0] & 0x0C));
+    TEST_CHECK(test_crc(frame, sizeof(frame) - 2) == (uint16_t)((frame[8] << 8) | frame[9]));
+
+    // An injected busy flag stays set for IFX_I2C_FAULT_BUSY_POLLS reads of the I2C state
+    ifx_i2c_fault_init(1);
+    ifx_i2c_fault_set_rate(IFX_I2C_FAULT_BUSY, 0xFFFF);
+    for (i = 0; i < IFX_I2C_FAULT_BUSY_POLLS; i++)
+    {
+        memcpy(frame, m_state, sizeof(m_state));
+        length = sizeof(m_state);
+        ifx_i2c_fault_transmit(m_poll, sizeof(m_poll));
+        ifx_i2c_fault_receive(frame, &length);
+        TEST_CHECK(frame[0] & 0x80);
+    }
+    ifx_i2c_fault_get_counts(counts, 0);
+    TEST_CHECK(counts[IFX_I2C_FAULT_BUSY] == 1);
+
+    return TEST_RESULT();
+}
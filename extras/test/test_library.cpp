@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// OPTIGA Trust E Command Library - Host test of the signature decoding and the priority queue (source file)
+//
+// The library is built with the Arduino HAL on the host versions of Arduino.h and Wire.h in arduino/,
+// the Wire is connected to the simulated device.
+
+#include "OPTIGATrustE.h"
+#include "sim_device.h"
+#include "test.h"
+
+#define TEST_ORDER_LEN      8
+#define TEST_MESSAGE_LEN    16
+#define TEST_RAW_HALF       (OPTIGA_SIGNATURE_RAW_LEN / 2)
+
+static OPTIGATrustE trustE;
+
+// Contexts of the queued commands in the order their callbacks were called
+static uintptr_t m_order[TEST_ORDER_LEN];
+static uint8_t   m_order_len;
+static uint16_t  m_status[TEST_ORDER_LEN];
+static uint32_t  m_length[TEST_ORDER_LEN];
+
+static void test_callback(uint16_t status, uint32_t length, void* context)
+{
+    if (m_order_len < TEST_ORDER_LEN)
+    {
+        m_status[m_order_len] = status;
+        m_length[m_order_len] = length;
+        m_order[m_order_len++] = (uintptr_t)context;
+    }
+}
+
+static void test_poll(void)
+{
+    while (trustE.poll())
+    {
+    }
+}
+
+// Returns true if every byte of r is r_value and every byte of s is s_value
+static bool test_raw(const uint8_t* raw, uint8_t r_value, uint8_t s_value)
+{
+    uint8_t i;
+
+    for (i = 0; i < TEST_RAW_HALF; i++)
+    {
+        if (raw[i] != r_value || raw[TEST_RAW_HALF + i] != s_value)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_decode_signature(void)
+{
+    uint8_t der[OPTIGA_SIGNATURE_MAX_LEN];
+    uint8_t raw[OPTIGA_SIGNATURE_RAW_LEN];
+
+    // 32 byte integers
+    der[0] = 0x30; der[1] = 68;
+    der[2] = 0x02; der[3] = 32; memset(der + 4, 0x11, 32);
+    der[36] = 0x02; der[37] = 32; memset(der + 38, 0x22, 32);
+    TEST_CHECK(OPTIGATrustE::decodeSignature(der, 70, raw) == IFX_I2C_STACK_SUCCESS);
+    TEST_CHECK(test_raw(raw, 0x11, 0x22));
+
+    // r with the top bit set carries a leading zero, s is shorter and padded
+    der[0] = 0x30; der[1] = 68;
+    der[2] = 0x02; der[3] = 33; der[4] = 0x00; memset(der + 5, 0x91, 32);
+    der[37] = 0x02; der[38] = 31; memset(der + 39, 0x22, 31);
+    TEST_CHECK(OPTIGATrustE::decodeSignature(der, 70, raw) == IFX_I2C_STACK_SUCCESS);
+    TEST_CHECK(raw[0] == 0x91 && memcmp(raw, raw + 1, TEST_RAW_HALF - 1) == 0);
+    TEST_CHECK(raw[TEST_RAW_HALF] == 0x00 && raw[TEST_RAW_HALF + 1] == 0x22
+               && memcmp(raw + TEST_RAW_HALF + 1, raw + TEST_RAW_HALF + 2, TEST_RAW_HALF - 2) == 0);
+
+    // Invalid encodings
+    der[0] = 0x30; der[1] = 68;
+    der[2] = 0x02; der[3] = 32; memset(der + 4, 0x11, 32);
+    der[36] = 0x02; der[37] = 32; memset(der + 38, 0x22, 32);
+    TEST_CHECK(OPTIGATrustE::decodeSignature(der, 69, raw) == IFX_I2C_STACK_ERROR);
+    TEST_CHECK(OPTIGATrustE::decodeSignature(NULL, 70, raw) == IFX_I2C_STACK_ERROR);
+    der[0] = 0x31;
+    TEST_CHECK(OPTIGATrustE::decodeSignature(der, 70, raw) == IFX_I2C_STACK_ERROR);
+    der[0] = 0x30;
+    der[36] = 0x04;
+    TEST_CHECK(OPTIGATrustE::decodeSignature(der, 70, raw) == IFX_I2C_STACK_ERROR);
+    der[36] = 0x02;
+    der[37] = 33;
+    TEST_CHECK(OPTIGATrustE::decodeSignature(der, 70, raw) == IFX_I2C_STACK_ERROR);
+
+    // A number of 33 bytes without a leading zero does not fit
+    der[0] = 0x30; der[1] = 69;
+    der[2] = 0x02; der[3] = 33; memset(der + 4, 0x11, 33);
+    der[37] = 0x02; der[38] = 32; memset(der + 39, 0x22, 32);
+    TEST_CHECK(OPTIGATrustE::decodeSignature(der, 71, raw) == IFX_I2C_STACK_ERROR);
+}
+
+static void test_signature(void)
+{
+    uint8_t message[TEST_MESSAGE_LEN] = {0};
+    uint8_t raw[OPTIGA_SIGNATURE_RAW_LEN];
+
+    // The simulated device signs with r = 0x11.. and s = 0x22..
+    TEST_CHECK(trustE.getSignatureRaw(message, sizeof(message), raw) == IFX_I2C_STACK_SUCCESS);
+    TEST_CHECK(test_raw(raw, 0x11, 0x22));
+}
+
+static void test_queue_order(void)
+{
+    static const uint8_t get_uid[] = {0x01, 0x00, 0x00, 0x02, 0xE0, 0xC2};
+    uint8_t message[TEST_MESSAGE_LEN] = {0};
+    uint8_t uid[3][OPTIGA_UID_LEN];
+    uint8_t signature[OPTIGA_SIGNATURE_MAX_LEN];
+    uint8_t certificate[SIM_CERTIFICATE_LEN];
+    uint8_t raw[OPTIGA_SIGNATURE_RAW_LEN];
+    int apdus;
+
+    // Queued before poll() runs: the highest class first, the order of queueing within a class
+    m_order_len = 0;
+    TEST_CHECK(trustE.queueReadObject(OPTIGA_PRIORITY_BACKGROUND, 0xE0, 0xE0, 0, sizeof(certificate), certificate,
+                                      test_callback, (void*)1) == IFX_I2C_STACK_SUCCESS);
+    TEST_CHECK(trustE.queueTransceive(OPTIGA_PRIORITY_NORMAL, get_uid, sizeof(get_uid), uid[0], sizeof(uid[0]),
+                                      test_callback, (void*)2) == IFX_I2C_STACK_SUCCESS);
+    TEST_CHECK(trustE.queueTransceive(OPTIGA_PRIORITY_HIGH, get_uid, sizeof(get_uid), uid[1], sizeof(uid[1]),
+                                      test_callback, (void*)3) == IFX_I2C_STACK_SUCCESS);
+    TEST_CHECK(trustE.queueTransceive(OPTIGA_PRIORITY_NORMAL, get_uid, sizeof(get_uid), uid[2], sizeof(uid[2]),
+                                      test_callback, (void*)4) == IFX_I2C_STACK_SUCCESS);
+    // The queue is full
+    TEST_CHECK(trustE.queueTransceive(OPTIGA_PRIORITY_HIGH, get_uid, sizeof(get_uid), uid[1], sizeof(uid[1]),
+                                      test_callback, (void*)5) == IFX_I2C_STACK_ERROR);
+    test_poll();
+    TEST_CHECK(m_order_len == 4);
+    TEST_CHECK(m_order[0] == 3 && m_order[1] == 2 && m_order[2] == 4 && m_order[3] == 1);
+    TEST_CHECK(m_status[0] == IFX_I2C_STACK_SUCCESS && m_status[3] == IFX_I2C_STACK_SUCCESS);
+    TEST_CHECK(m_length[0] == SIM_UID_LEN && m_length[3] == SIM_CERTIFICATE_LEN);
+
+    // A signature queued while the certificate is read runs between two chunks of the read
+    m_order_len = 0;
+    apdus = sim_apdu_count();
+    TEST_CHECK(trustE.queueReadObject(OPTIGA_PRIORITY_BACKGROUND, 0xE0, 0xE0, 0, sizeof(certificate), certificate,
+                                      test_callback, (void*)1) == IFX_I2C_STACK_SUCCESS);
+    while (sim_apdu_count() == apdus)
+    {
+        trustE.poll();
+    }
+    TEST_CHECK(trustE.queueSignature(OPTIGA_PRIORITY_HIGH, message, sizeof(message), signature, sizeof(signature),
+                                     test_callback, (void*)2) == IFX_I2C_STACK_SUCCESS);
+    test_poll();
+    TEST_CHECK(m_order_len == 2);
+    TEST_CHECK(m_order[0] == 2 && m_order[1] == 1);
+    TEST_CHECK(m_status[0] == IFX_I2C_STACK_SUCCESS && m_status[1] == IFX_I2C_STACK_SUCCESS);
+    TEST_CHECK(m_length[1] == SIM_CERTIFICATE_LEN);
+    TEST_CHECK(OPTIGATrustE::decodeSignature(signature, m_length[0], raw) == IFX_I2C_STACK_SUCCESS
+               && test_raw(raw, 0x11, 0x22));
+}
+
+int main(void)
+{
+    test_decode_signature();
+
+    sim_reset();
+    TEST_CHECK(trustE.begin() == IFX_I2C_STACK_SUCCESS);
+    test_signature();
+    test_queue_order();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// IFX I2C Protocol Stack - Host test of the streaming transport layer (source file)
+//
+// Built with IFX_I2C_TL_STREAMING set to 1: the fragments of a chained response are passed on as they
+// arrive and must add up to the response, also if a frame has to be read again.
+
+#include "host_stack.h"
+#include "ifx_i2c_data_link_layer.h"
+#include "sim_device.h"
+#include "test.h"
+#include <string.h>
+
+// Number of fragments of a response, each fragment starts with the packet control byte
+#define TEST_FRAGMENTS(length)  (((length) + TL_MAX_FRAGMENT_SIZE - 2) / (TL_MAX_FRAGMENT_SIZE - 1))
+
+// Reads the certificate and compares the streamed fragments with the object of the device
+static void test_certificate(void)
+{
+    const uint8_t* certificate;
+    uint16_t certificate_len = 0;
+
+    certificate = sim_object(SIM_OID_CERTIFICATE, &certificate_len);
+    TEST_CHECK(host_transceive(host_get_certificate, sizeof(host_get_certificate)) == IFX_I2C_TL_EVENT_SUCCESS);
+    TEST_CHECK(host_response_len == HOST_RESPONSE_HEADER_LEN + SIM_CERTIFICATE_LEN);
+    TEST_CHECK(host_fragments == TEST_FRAGMENTS(HOST_RESPONSE_HEADER_LEN + SIM_CERTIFICATE_LEN));
+    TEST_CHECK(host_response_len == HOST_RESPONSE_HEADER_LEN + certificate_len
+               && memcmp(host_response + HOST_RESPONSE_HEADER_LEN, certificate, certificate_len) == 0);
+}
+
+int main(void)
+{
+    ifx_i2c_dl_stats_t stats;
+
+    sim_reset();
+    TEST_CHECK(host_init() == IFX_I2C_STACK_SUCCESS);
+    TEST_CHECK(host_transceive(host_open_application, sizeof(host_open_application)) == IFX_I2C_TL_EVENT_SUCCESS);
+    TEST_CHECK(host_response_len == HOST_RESPONSE_HEADER_LEN);
+    TEST_CHECK(host_fragments == 1);
+
+    test_certificate();
+
+    // A fragment read again after a CRC error is passed on once
+    ifx_i2c_dl_get_stats(NULL, 1);
+    sim_corrupt(1);
+    test_certificate();
+    ifx_i2c_dl_get_stats(&stats, 0);
+    TEST_CHECK(stats.crc_errors == 1);
+
+    // A response of two fragments, the second one partly filled
+    TEST_CHECK(host_transceive(host_get_uid, sizeof(host_get_uid)) == IFX_I2C_TL_EVENT_SUCCESS);
+    TEST_CHECK(host_response_len == HOST_RESPONSE_HEADER_LEN + SIM_UID_LEN);
+    TEST_CHECK(host_fragments == TEST_FRAGMENTS(HOST_RESPONSE_HEADER_LEN + SIM_UID_LEN));
+
+    return TEST_RESULT();
+}
@@ -32,24 +32,31 @@
 */
 
 #include "OPTIGATrustE.h"
-
-//these variables can be found in ifx_i2c_hal.c
-extern uint8_t m_timer_done;
-extern volatile IFX_Timer_Callback timer_callback;
-extern uint16_t ifx_i2c_optiga_soft_reset(void);
+#include "OPTIGATrustECertificate.h"
+extern "C"
+{
+#include "util/sha256/sha256.h"
+}
 
 // Command headers
 #define OPTIGA_CMD_HEADER_LEN                   4
-#define HEADER_SPACE                            0x00, 0x00, 0x00, 0x00
 #define OPTIGA_CMD_FLAG_FLUSH_LAST_ERROR        0x80
+// Command header as constant initializer, equivalent to CreateHeader for fixed length commands
+#define OPTIGA_CMD_HEADER(command, param, payload_len) \
+    (uint8_t)((command) | OPTIGA_CMD_FLAG_FLUSH_LAST_ERROR), (uint8_t)(param), \
+    (uint8_t)((payload_len) >> 8), (uint8_t)(payload_len)
 
 // Command status codes
 #define OPTIGA_CMD_STATUS_SUCCESS               0x00
 
 // Command Open Application
 #define OPTIGA_CMD_OPEN_APPLICATION             0x70
+// Command byte of an APDU (with or without the flush last error flag) opens the application
+#define OPTIGA_CMD_IS_OPEN_APPLICATION(apdu)    \
+    (((apdu)[0] & ~OPTIGA_CMD_FLAG_FLUSH_LAST_ERROR) == OPTIGA_CMD_OPEN_APPLICATION)
 #define APP_ID                                  0xD2, 0x76, 0x00, 0x00, 0x04, 0x47, 0x65, 0x6E, \
                                                 0x41, 0x75, 0x74, 0x68, 0x41, 0x70, 0x70, 0x6C
+#define APP_ID_LEN                              16
 
 // Command Set Auth Scheme
 #define OPTIGA_CMD_SET_AUTH_SCHEME              0x10
@@ -74,6 +81,16 @@ extern uint16_t ifx_i2c_optiga_soft_reset(void);
 #define OPTIGA_CMD_SET_DATA_OBJECT              0x02
 #define OPTIGA_PARAM_WRITE_DATA                 0x00
 #define WRITE_OFFSET                            0x00,0x00
+// Length of tag, OID and write offset preceding the data of a set data object command
+#define OPTIGA_SET_DATA_HEADER_LEN              4
+// Number of transport layer fragments filled by one chunk of a data object write
+#ifndef OPTIGA_WRITE_CHUNK_FRAGMENTS
+#define OPTIGA_WRITE_CHUNK_FRAGMENTS            4
+#endif
+// Maximum data written with one set data object command at the largest frame size (fills the fragments,
+// each has one byte chaining header)
+#define OPTIGA_WRITE_CHUNK_SIZE                 (OPTIGA_WRITE_CHUNK_FRAGMENTS * (TL_MAX_FRAGMENT_SIZE - 1) \
+                                                 - OPTIGA_CMD_HEADER_LEN - OPTIGA_SET_DATA_HEADER_LEN)
 // Data structure object identifiers
 #define OPTIGA_OID_TAG                          0xE0
 #define OPTIGA_OID_PRIVATE_KEY                  0xF0
@@ -105,325 +122,1908 @@ extern uint16_t ifx_i2c_optiga_soft_reset(void);
 #define     SECURITY_STATUS_A                   0xC1
 /// Error codes
 #define     ERROR_CODES                         0xC2
+/// Number of one byte configuration objects held by the shadow, see OPTIGATrustE::loadConfig
+#define OPTIGA_CONFIG_COUNT                     4
+#define OPTIGA_CONFIG_NONE                      0xFF
+
+// Length of the ASN.1 header of a sequence with extended length (0x30 0x82 length_high length_low)
+#define OPTIGA_DER_HEADER_LEN                   4
+
+// Automatic bus clock selection: transactions per clock during probing
+#ifndef OPTIGA_CLOCK_PROBE_ROUNDS
+#define OPTIGA_CLOCK_PROBE_ROUNDS               4
+#endif
+// Automatic bus clock selection: the clock is lowered if this many data link errors occur ...
+#ifndef OPTIGA_CLOCK_FALLBACK_ERRORS
+#define OPTIGA_CLOCK_FALLBACK_ERRORS            3
+#endif
+// ... within this many transactions
+#ifndef OPTIGA_CLOCK_FALLBACK_WINDOW
+#define OPTIGA_CLOCK_FALLBACK_WINDOW            16
+#endif
+#define OPTIGA_CLOCK_UNMANAGED                  0xFF
+
+// Initialization states, see OPTIGATrustE::beginAsync
+#define OPTIGA_BOOT_IDLE                        0
+#define OPTIGA_BOOT_START                       1
+#define OPTIGA_BOOT_OPEN                        2
+#define OPTIGA_BOOT_READY                       3
+#define OPTIGA_BOOT_FAILED                      4
+// Time limit of beginAsync(void) in milliseconds
+#ifndef OPTIGA_BOOT_TIMEOUT_MS
+#define OPTIGA_BOOT_TIMEOUT_MS                  2000
+#endif
+
+// Command queue, see OPTIGATrustE::poll: number of commands that can be queued ...
+#ifndef OPTIGA_QUEUE_SIZE
+#define OPTIGA_QUEUE_SIZE                       4
+#endif
+// ... and the largest part of a data object read by one command of a queued read
+#ifndef OPTIGA_QUEUE_READ_CHUNK
+#define OPTIGA_QUEUE_READ_CHUNK                 128
+#endif
+#define OPTIGA_QUEUE_NONE                       0xFF
+// Kinds of queued commands
+#define OPTIGA_QUEUE_FREE                       0
+#define OPTIGA_QUEUE_TRANSCEIVE                 1
+#define OPTIGA_QUEUE_READ                       2
+#define OPTIGA_QUEUE_SIGNATURE                  3
+// Commands of a queued signature, the auth scheme is skipped if it is selected already
+#define OPTIGA_QUEUE_STEP_SCHEME                0
+#define OPTIGA_QUEUE_STEP_MESSAGE               1
+#define OPTIGA_QUEUE_STEP_SIGNATURE             2
+
+// Recovery tiers, see OPTIGATrustE::recover
+#define OPTIGA_RECOVERY_RESYNC                  0
+#define OPTIGA_RECOVERY_REOPEN                  1
+#define OPTIGA_RECOVERY_SOFT_RESET              2
+
+// Prebuilt APDUs of commands without variable parameters
+static const uint8_t m_apdu_open_application[] =
+    { OPTIGA_CMD_HEADER(OPTIGA_CMD_OPEN_APPLICATION, 0x00, APP_ID_LEN), APP_ID };
+static const uint8_t m_apdu_set_auth_scheme[] =
+    { OPTIGA_CMD_HEADER(OPTIGA_CMD_SET_AUTH_SCHEME, OPTIGA_AUTH_ECDSA_SECP256R1_SHA256, 2), OID_PRIVATE_KEY };
+static const uint8_t m_apdu_get_signature[] =
+    { OPTIGA_CMD_HEADER(OPTIGA_CMD_GET_AUTH_MSG, OPTIGA_PARAM_SIGNATURE, 0) };
+static const uint8_t m_apdu_get_certificate[] =
+    { OPTIGA_CMD_HEADER(OPTIGA_CMD_GET_DATA_OBJECT, OPTIGA_PARAM_READ_DATA, 2), OID_CERTIFICATE };
+static const uint8_t m_apdu_get_uid[] =
+    { OPTIGA_CMD_HEADER(OPTIGA_CMD_GET_DATA_OBJECT, OPTIGA_PARAM_READ_DATA, 2), OPTIGA_OID_TAG, COPROCESSOR_UID };
+
+// Length of the data objects holding a single byte (life cycle status, security status, ...)
+#define OPTIGA_OBJECT_BYTE_LEN                  1
+
+// Public key of misc/Infineon OPTIGA(TM) Trust E CA 001.crt, which issues the device certificates
+static const uint8_t m_ca_public_key[OPTIGA_PUBLIC_KEY_LEN] =
+{
+    0x04, 0x01, 0xec, 0x1e, 0x27, 0xeb, 0x94, 0x86, 0x4e, 0xe8, 0x8c, 0xf3, 0x2f, 0x3a, 0xdf, 0x14,
+    0x71, 0x31, 0x14, 0x3f, 0x29, 0xf0, 0x49, 0x9e, 0xb1, 0x50, 0x22, 0x06, 0x7f, 0xbc, 0x58, 0x1f,
+    0x2f, 0x86, 0xa0, 0xf5, 0xf2, 0x43, 0xf9, 0x93, 0x04, 0x9d, 0xa6, 0x0c, 0x6a, 0xf8, 0xed, 0xdf,
+    0x02, 0x5a, 0x17, 0xae, 0x2c, 0xdb, 0xda, 0x96, 0xed, 0xfa, 0x20, 0xc7, 0x0f, 0x5d, 0xc0, 0xa0,
+    0x63
+};
+// AlgorithmIdentifier of ecdsa-with-SHA256 without the SEQUENCE header
+static const uint8_t m_ecdsa_with_sha256[] = { 0x06, 0x08, 0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x04, 0x03, 0x02 };
+
+// Bus clocks tried by probeClock, fastest first
+static const uint32_t m_clock_rates[] = { 1000000, 400000, 100000 };
+#define OPTIGA_CLOCK_RATES_COUNT                (sizeof(m_clock_rates) / sizeof(m_clock_rates[0]))
+
+// Automatic bus clock selection: index of the selected clock and errors within the current window
+static          uint8_t   m_clock_index = OPTIGA_CLOCK_UNMANAGED;
+static          uint8_t   m_clock_transactions;
+static          uint8_t   m_clock_errors;
+static          uint16_t  m_clock_dl_errors;
+
+// Recovery: set once the auth scheme was selected, it is applied again if the application is re-opened
+static          uint8_t   m_auth_scheme_set;
+// The auth scheme is selected in the current application session, cleared when the application is opened
+static          uint8_t   m_auth_scheme_session;
+static OPTIGATrustERecoveryStats m_recovery_stats;
+
+// Shadow of the one byte configuration objects (tag, OID), see OPTIGATrustE::loadConfig. The security status
+// objects are updated by the device itself and not shadowed. Committed in this order: the life cycle states
+// last, they only move forward and can tighten the access conditions of the other objects.
+static const uint8_t m_config_objects[OPTIGA_CONFIG_COUNT][2] =
+{
+    { OPTIGA_OID_TAG, SLEEP_MODE_ACTIVATION_DELAY },
+    { OPTIGA_OID_TAG, CURRENT_LIMITATION },
+    { OPTIGA_APP_TAG, LCS_A },
+    { OPTIGA_OID_TAG, LCS_G }
+};
+static uint8_t m_config_value[OPTIGA_CONFIG_COUNT];
+static uint8_t m_config_dirty;          // One bit per object, set if the shadow differs from the device
+static uint8_t m_config_loaded;
+
+// Initialization running in the background
+static volatile uint8_t   m_boot_state = OPTIGA_BOOT_IDLE;
+static          uint32_t  m_boot_start;
+static          uint32_t  m_boot_phase_start;
+static          uint32_t  m_boot_timeout_us;
+static OPTIGATrustEBootTiming m_boot_timing;
+static OPTIGATrustEReadyCallback m_boot_callback;
+static void*              m_boot_context;
+
+// Queued command
+typedef struct
+{
+    uint8_t   kind;             // OPTIGA_QUEUE_FREE if the entry is not used
+    uint8_t   priority;
+    uint8_t   step;             // Command of a signature sent next
+    uint32_t  sequence;         // Order of queueing
+    uint32_t  queued_us;
+    const uint8_t* apdu;        // Raw command APDU
+    uint16_t  apdu_length;
+    uint8_t*  response;
+    uint16_t  size;             // Size of response, the number of bytes to read for a data object
+    uint16_t  length;           // Response bytes received so far
+    uint8_t   tag;
+    uint8_t   OID;
+    uint16_t  offset;           // Position of the first byte to read within the data object
+    uint8_t   message[OPTIGA_AUTH_MSG_LEN];
+    OPTIGATrustECommandCallback callback;
+    void*     context;
+} optiga_queue_entry_t;
+
+// Command queue, served by OPTIGATrustE::poll
+static optiga_queue_entry_t m_queue[OPTIGA_QUEUE_SIZE];
+static          uint32_t  m_queue_sequence;
+static          uint8_t   m_queue_current = OPTIGA_QUEUE_NONE;  // Entry being sent or between the commands of a signature
+static          uint8_t   m_queue_sending;                      // A command of the current entry is with the stack
+static volatile uint8_t   m_queue_polling;                      // poll() is running, in this or another context
+static          uint8_t   m_queue_apdu[OPTIGA_CMD_HEADER_LEN + OPTIGA_AUTH_MSG_LEN];
+static OPTIGATrustEQueueStats m_queue_stats[OPTIGA_PRIORITY_COUNT];
+
+// Device sharing the bus, see OPTIGATrustE::shareBus
+typedef struct
+{
+    OPTIGATrustEBusCallback callback;
+    void*     context;
+    uint32_t  duration_us;
+    uint32_t  last_us;          // Last use of the bus
+    uint32_t  reset_us;         // Start of the statistics
+    OPTIGATrustEBusStats stats;
+} optiga_bus_device_t;
+
+static optiga_bus_device_t m_bus_devices[OPTIGA_BUS_DEVICES_MAX];
+static          uint8_t   m_bus_device_count;
+static          uint8_t   m_bus_next;                   // Device asked first in the next window
+static          uint32_t  m_bus_command_start;
+// Bus occupancy of the Optiga Trust E, the bus time is counted by the HAL
+static          uint32_t  m_bus_optiga_commands;
+static          uint32_t  m_bus_optiga_base_us;
+static          uint32_t  m_bus_optiga_reset_us;
 
 // Members to use library in blocking mode
 static volatile uint8_t   m_ifx_i2c_busy = 0;
 static volatile uint8_t   m_ifx_i2c_status;
-static volatile uint8_t* m_optiga_rx_buffer;
+
+// Response sink: the header and the first data bytes are kept here, the response data is
+// written to the caller's buffer or passed to the caller's callback
+static          uint8_t   m_optiga_rx_header[OPTIGA_CMD_HEADER_LEN + OPTIGA_DER_HEADER_LEN];
 static volatile uint16_t  m_optiga_rx_len;
+static          uint8_t*  m_optiga_rx_buffer;
+static volatile uint16_t  m_optiga_rx_size;
+// Options for a single transaction, reset once the transaction is complete
+static volatile uint8_t   m_optiga_rx_der;
+static OPTIGATrustEChunkCallback m_optiga_rx_callback;
+static void*              m_optiga_rx_context;
 
 // Wire used by Optiga Trust E
 TwoWire* OptigaWire = &Wire;
 
 /**
- * The event handler, which is called when the transport layer is done communicating with the lower levels and the operation has been carried out
+ * This function reserves the protocol stack for one transaction. The flag is tested and set under the lock,
+ * so of two contexts starting a transaction at the same time only one gets the stack.
  */
-static void ifx_i2c_tl_event_handler(uint8_t event, uint8_t* data, uint16_t data_len)
+static uint16_t optiga_stack_claim(void)
 {
-    m_optiga_rx_buffer = data;
-    m_optiga_rx_len = data_len;
-    m_ifx_i2c_status = event;
-    m_ifx_i2c_busy = 0;
+    OPTIGA_QUEUE_LOCK();
+    if (m_ifx_i2c_busy)
+    {
+        OPTIGA_QUEUE_UNLOCK();
+        return IFX_I2C_STACK_ERROR;
+    }
+    m_ifx_i2c_busy = 1;
+    OPTIGA_QUEUE_UNLOCK();
+
+    return IFX_I2C_STACK_SUCCESS;
 }
 
-OPTIGATrustE::OPTIGATrustE()
+/**
+ * This function resets the sink options which apply to a single transaction only
+ */
+static void optiga_rx_reset_options(void)
+{
+    m_optiga_rx_der = 0;
+    m_optiga_rx_callback = NULL;
+    m_optiga_rx_context = NULL;
+}
+
+/**
+ * This function hands the apdu to the transport layer once the stack is claimed, the claim ends with the transaction
+ */
+static uint16_t optiga_stack_start(const uint8_t* data, uint16_t length, uint8_t* response, uint16_t response_size)
 {
+    // Prepare the sink for the response
+    m_optiga_rx_len = 0;
+    m_optiga_rx_buffer = response;
+    m_optiga_rx_size = response_size;
 
+    if (ifx_i2c_tl_transceive(data, length))
+    {
+        optiga_rx_reset_options();
+        m_ifx_i2c_busy = 0;
+        return IFX_I2C_STACK_ERROR;
+    }
+    m_bus_optiga_commands++;
+    return IFX_I2C_STACK_SUCCESS;
 }
 
-OPTIGATrustE::~OPTIGATrustE()
+/**
+ * This function returns the number of data link errors counted so far (wraps around, cleared with the
+ * statistics by ifx_i2c_dl_get_stats)
+ */
+static uint16_t optiga_clock_dl_errors(void)
 {
+    ifx_i2c_dl_stats_t stats;
 
+    ifx_i2c_dl_get_stats(&stats, 0);
+    return stats.crc_errors + stats.nacks + stats.pl_errors;
 }
 
 /**
- * This function creates the header of length 4, which includes the command, param and the length of the data
+ * This function starts a new error window for the selected clock
  */
-void OPTIGATrustE::CreateHeader(uint8_t* header, uint8_t command, uint8_t param,
-                               uint16_t payload_len)
+static void optiga_clock_restart_window(void)
 {
-    header[0] = command | OPTIGA_CMD_FLAG_FLUSH_LAST_ERROR;
-    header[1] = param;
-    header[2] = payload_len >> 8;
-    header[3] = payload_len;
+    m_clock_transactions = 0;
+    m_clock_errors = 0;
+    m_clock_dl_errors = optiga_clock_dl_errors();
 }
 
 /**
- * This function sends the apdu to the transport layer, which deals with the communication with the Optiga Trust E.
- * At the end of the operation, the handler is called.
+ * This function counts the data link errors of the last transaction and lowers the bus clock
+ * if too many errors occurred within the current window
  */
-uint16_t OPTIGATrustE::SendApdu(uint8_t* data, uint16_t length)
+static void optiga_clock_track(void)
 {
-    uint16_t response_len = 0;
+    uint16_t total;
+    uint16_t errors;
 
-    m_ifx_i2c_busy = 1;
-    if (ifx_i2c_tl_transceive(data, length))
+    if (m_clock_index == OPTIGA_CLOCK_UNMANAGED)
     {
-        return IFX_I2C_STACK_ERROR;
+        return;
     }
 
-
-    /**
-     *  Due to the recursive implementation of transport layer, datalink layer and physical layer,
-     *  the process below will reduce the size of the stack each time the ifx_timer_setup function is called in the ifx_i2c_hal.c.
-     */
-    while (m_ifx_i2c_busy)
+    // Counters lower than before were cleared (or wrapped around), only the errors since then are known
+    total = optiga_clock_dl_errors();
+    if (total < m_clock_dl_errors)
     {
-        //Wait
-        if (m_timer_done)
-        {
-            m_timer_done = 0;
-            if (timer_callback)
-            {
-                timer_callback();
-            }
-        }
+        m_clock_dl_errors = 0;
     }
-
-    if (m_optiga_rx_len < OPTIGA_CMD_HEADER_LEN)
+    errors = total - m_clock_dl_errors;
+    if (errors > OPTIGA_CLOCK_FALLBACK_ERRORS - m_clock_errors)
     {
-        return IFX_I2C_STACK_ERROR;
+        m_clock_errors = OPTIGA_CLOCK_FALLBACK_ERRORS;
     }
-    if (m_optiga_rx_buffer[0] != OPTIGA_CMD_STATUS_SUCCESS)
+    else
     {
-        return IFX_I2C_STACK_ERROR;
+        m_clock_errors += errors;
     }
+    m_clock_dl_errors = total;
+    m_clock_transactions++;
 
-    response_len = (m_optiga_rx_buffer[2] << 8) | m_optiga_rx_buffer[3];
-    if (OPTIGA_CMD_HEADER_LEN + response_len != m_optiga_rx_len)
+    if (m_clock_errors >= OPTIGA_CLOCK_FALLBACK_ERRORS)
     {
-        return IFX_I2C_STACK_ERROR;
+        if (m_clock_index + 1u < OPTIGA_CLOCK_RATES_COUNT)
+        {
+            m_clock_index++;
+            Wire_setClock(m_clock_rates[m_clock_index]);
+        }
+        optiga_clock_restart_window();
+    }
+    else if (m_clock_transactions >= OPTIGA_CLOCK_FALLBACK_WINDOW)
+    {
+        optiga_clock_restart_window();
     }
+}
 
-    if (m_ifx_i2c_status == IFX_I2C_TL_EVENT_SUCCESS)
+/**
+ * This function records how long a device sharing the bus waited for it during the current command
+ */
+static void optiga_bus_waited(optiga_bus_device_t* device, uint32_t now)
+{
+    uint32_t since = device->last_us;
+    uint32_t wait;
+
+    // The wait starts with the command if the device used the bus before
+    if ((int32_t)(since - m_bus_command_start) < 0)
     {
-        return IFX_I2C_STACK_SUCCESS;
+        since = m_bus_command_start;
     }
-    else
+    wait = now - since;
+    if (wait > device->stats.max_wait_us)
     {
-        return IFX_I2C_STACK_ERROR;
+        device->stats.max_wait_us = wait;
     }
 }
 
-uint16_t OPTIGATrustE::begin(void)
+/**
+ * This function lets the devices sharing the bus use it while the stack does not need it, one after the other
+ */
+static void optiga_bus_share(void)
 {
-    return begin(Wire);
-}
+    optiga_bus_device_t* device;
+    uint32_t window;
+    uint32_t start;
+    uint8_t i;
 
-uint16_t OPTIGATrustE::begin(TwoWire& CustomWire)
-{
-    uint8_t apdu[] = { HEADER_SPACE, APP_ID };
-	
-    // Set global wire used with Optiga
-    OptigaWire = &CustomWire;
+    for (i = 0; i < m_bus_device_count; i++)
+    {
+        window = ifx_i2c_hal_idle_us();
+        if (window == 0)
+        {
+            return;
+        }
 
-    CreateHeader(apdu, OPTIGA_CMD_OPEN_APPLICATION, 0x00,
-                       sizeof(apdu) - OPTIGA_CMD_HEADER_LEN);
+        device = &m_bus_devices[m_bus_next];
+        m_bus_next = (m_bus_next + 1) % m_bus_device_count;
+        if (device->duration_us > window)
+        {
+            continue;
+        }
 
-    if (ifx_i2c_tl_init(ifx_i2c_tl_event_handler) != IFX_I2C_STACK_SUCCESS)
-    {
-        return IFX_I2C_STACK_ERROR;
+        start = micros();
+        if (device->callback(window, device->context))
+        {
+            optiga_bus_waited(device, start);
+            device->last_us = micros();
+            device->stats.transactions++;
+            device->stats.busy_us += device->last_us - start;
+        }
     }
-    return SendApdu(apdu, sizeof(apdu));
 }
 
-uint16_t OPTIGATrustE::reset(void)
+/**
+ * This function ends the wait of the devices sharing the bus at the end of a command
+ */
+static void optiga_bus_command_done(void)
 {
-	if(OptigaWire == NULL)
-	{
-        return IFX_I2C_STACK_ERROR;
-	}
-	
-    end();
-    return begin(*OptigaWire);
-}
+    uint32_t now = micros();
+    uint8_t i;
 
-void OPTIGATrustE::end(void)
-{
-#ifdef WIRE_HAS_END
-    OptigaWire->end();
-#endif
+    for (i = 0; i < m_bus_device_count; i++)
+    {
+        optiga_bus_waited(&m_bus_devices[i], now);
+        m_bus_devices[i].last_us = now;
+    }
 }
 
-
-uint16_t OPTIGATrustE::getCertificate(uint8_t pp_cert[], uint32_t& p_length)
+/**
+ * This function appends a part of the response to the sink. The header is stored internally,
+ * the response data is copied to the caller's buffer as far as it fits or handed to the callback.
+ */
+static void optiga_rx_push(const uint8_t* data, uint16_t data_len)
 {
-    uint8_t apdu[] = { HEADER_SPACE, OID_CERTIFICATE };
-    CreateHeader(apdu, OPTIGA_CMD_GET_DATA_OBJECT, OPTIGA_PARAM_READ_DATA,
-                       sizeof(apdu) - OPTIGA_CMD_HEADER_LEN);
+    uint16_t offset;
+    uint16_t length;
 
-    if (SendApdu(apdu, sizeof(apdu)))
+    // Response header
+    while (data_len && m_optiga_rx_len < OPTIGA_CMD_HEADER_LEN)
     {
-        return IFX_I2C_STACK_ERROR;
+        m_optiga_rx_header[m_optiga_rx_len++] = *data++;
+        data_len--;
     }
-    // Determine true length without trailing zero bytes
-    if (m_optiga_rx_buffer[OPTIGA_CMD_HEADER_LEN] == 0x30)
+
+    // Response data
+    while (data_len)
     {
-        // ASN1 Sequence
-        if (m_optiga_rx_buffer[OPTIGA_CMD_HEADER_LEN + 1] == 0x82)
-        {
-            // ASN1 Extended Length UINT16
-            uint8_t* temp = (uint8_t*)(m_optiga_rx_buffer + OPTIGA_CMD_HEADER_LEN);
-            p_length = ((m_optiga_rx_buffer[OPTIGA_CMD_HEADER_LEN + 2] << 8)
-                        | m_optiga_rx_buffer[OPTIGA_CMD_HEADER_LEN + 3]) + 4;
+        offset = m_optiga_rx_len - OPTIGA_CMD_HEADER_LEN;
+        length = data_len;
 
-            //in this case if the p_length gives you the correct length of the certficate, please use (*p_length) instead of LENGTH_CERTIFICATE
-            memcpy(pp_cert, temp, p_length);
+        if (offset < OPTIGA_DER_HEADER_LEN)
+        {
+            // Keep the first bytes, for a certificate they contain the ASN.1 length
+            if (length > OPTIGA_DER_HEADER_LEN - offset)
+            {
+                length = OPTIGA_DER_HEADER_LEN - offset;
+            }
+            memcpy(m_optiga_rx_header + m_optiga_rx_len, data, length);
+        }
+        else if (m_optiga_rx_der && offset == OPTIGA_DER_HEADER_LEN
+                 && m_optiga_rx_header[OPTIGA_CMD_HEADER_LEN] == 0x30
+                 && m_optiga_rx_header[OPTIGA_CMD_HEADER_LEN + 1] == 0x82)
+        {
+            // Stop at the end of an ASN.1 sequence with extended length to skip trailing bytes
+            uint16_t der_len = ((m_optiga_rx_header[OPTIGA_CMD_HEADER_LEN + 2] << 8)
+                                | m_optiga_rx_header[OPTIGA_CMD_HEADER_LEN + 3]) + OPTIGA_DER_HEADER_LEN;
+            if (der_len < m_optiga_rx_size)
+            {
+                m_optiga_rx_size = der_len;
+            }
+        }
 
-            return IFX_I2C_STACK_SUCCESS;
+        if (offset < m_optiga_rx_size)
+        {
+            uint16_t copy_len = (length > m_optiga_rx_size - offset) ? m_optiga_rx_size - offset : length;
+            if (m_optiga_rx_callback != NULL)
+            {
+                m_optiga_rx_callback(data, offset, copy_len, m_optiga_rx_context);
+            }
+            else if (m_optiga_rx_buffer != NULL)
+            {
+                memcpy(m_optiga_rx_buffer + offset, data, copy_len);
+            }
         }
+        m_optiga_rx_len += length;
+        data += length;
+        data_len -= length;
     }
-    return IFX_I2C_STACK_ERROR;
 }
 
-uint16_t OPTIGATrustE::getRandom(uint16_t length, uint8_t p_random[])
+/**
+ * The event handler, which is called when the transport layer is done communicating with the lower levels and the operation has been carried out
+ */
+static void ifx_i2c_tl_event_handler(uint8_t event, uint8_t* data, uint16_t data_len)
 {
-    uint8_t apdu[] = { HEADER_SPACE, length >> 8, length };
-    CreateHeader(apdu, OPTIGA_CMD_GET_RANDOM, 0x00, 2);
-
-    if (p_random == NULL || length < 0x0008 || length > 0x100)
+    // Fragment of the response (streaming transport layer)
+    if (event == IFX_I2C_TL_EVENT_RX_FRAGMENT)
     {
-        return IFX_I2C_STACK_ERROR;
+        optiga_rx_push(data, data_len);
+        return;
     }
 
-    if (SendApdu(apdu, sizeof(apdu)))
+    // Complete response (buffering transport layer)
+    if (event == IFX_I2C_TL_EVENT_SUCCESS && data != NULL)
     {
-        return IFX_I2C_STACK_ERROR;
+        optiga_rx_push(data, data_len);
     }
 
-    memcpy(p_random, (uint8_t*)(m_optiga_rx_buffer + OPTIGA_CMD_HEADER_LEN), length);
-    return IFX_I2C_STACK_SUCCESS;
+    optiga_rx_reset_options();
+    m_ifx_i2c_status = event;
+    m_ifx_i2c_busy = 0;
 }
 
-uint16_t OPTIGATrustE::setAuthScheme(void)
+OPTIGATrustE::OPTIGATrustE()
 {
-    uint8_t apdu[] = { HEADER_SPACE, OID_PRIVATE_KEY };
-    CreateHeader(apdu, OPTIGA_CMD_SET_AUTH_SCHEME,
-                       OPTIGA_AUTH_ECDSA_SECP256R1_SHA256, sizeof(apdu) - OPTIGA_CMD_HEADER_LEN);
 
-    return SendApdu(apdu, sizeof(apdu));
 }
 
-uint16_t OPTIGATrustE::getSignature(uint8_t p_message[], uint16_t message_length,
-        uint8_t pp_signature[], uint32_t& p_signature_len)
+OPTIGATrustE::~OPTIGATrustE()
 {
-    uint8_t apdu[OPTIGA_CMD_HEADER_LEN + OPTIGA_AUTH_MSG_LEN];
-    CreateHeader(apdu, OPTIGA_CMD_SET_AUTH_MSG, OPTIGA_PARAM_CHALLENGE,
-                       OPTIGA_AUTH_MSG_LEN);
 
-    if (message_length != OPTIGA_AUTH_MSG_LEN)
+}
+
+/**
+ * This function creates the header of length 4, which includes the command, param and the length of the data
+ */
+void OPTIGATrustE::CreateHeader(uint8_t* header, uint8_t command, uint8_t param,
+                               uint16_t payload_len)
+{
+    header[0] = command | OPTIGA_CMD_FLAG_FLUSH_LAST_ERROR;
+    header[1] = param;
+    header[2] = payload_len >> 8;
+    header[3] = payload_len;
+}
+
+/**
+ * This function sends the apdu to the transport layer, which deals with the communication with the Optiga Trust E.
+ * At the end of the operation, the handler is called.
+ */
+uint16_t OPTIGATrustE::SendApdu(const uint8_t* data, uint16_t length, uint8_t* response, uint16_t response_size)
+{
+    // Commands wait for an initialization started with beginAsync
+    while (m_boot_state == OPTIGA_BOOT_START || m_boot_state == OPTIGA_BOOT_OPEN)
     {
-        return IFX_I2C_STACK_ERROR;
+        BootPoll();
     }
-    memcpy(apdu + OPTIGA_CMD_HEADER_LEN, p_message, message_length);
-    if (SendApdu(apdu, sizeof(apdu)))
+    if (m_boot_state == OPTIGA_BOOT_FAILED)
     {
         return IFX_I2C_STACK_ERROR;
     }
 
-    CreateHeader(apdu, OPTIGA_CMD_GET_AUTH_MSG, OPTIGA_PARAM_SIGNATURE, 0);
-    if (SendApdu(apdu, OPTIGA_CMD_HEADER_LEN))
+    // A queued command being sent is completed first (all commands of a signature), the next queued command
+    // waits. The sink options were set for this command, they must not apply to the queued one.
+    if (m_queue_current != OPTIGA_QUEUE_NONE)
     {
-        return IFX_I2C_STACK_ERROR;
-    }
+        uint8_t der = m_optiga_rx_der;
+        OPTIGATrustEChunkCallback callback = m_optiga_rx_callback;
+        void* context = m_optiga_rx_context;
 
-    uint8_t* temp = (uint8_t*)(m_optiga_rx_buffer + OPTIGA_CMD_HEADER_LEN);
-    p_signature_len = m_optiga_rx_len - OPTIGA_CMD_HEADER_LEN;
+        optiga_rx_reset_options();
+        while (m_queue_current != OPTIGA_QUEUE_NONE)
+        {
+            poll();
+        }
+        m_optiga_rx_der = der;
+        m_optiga_rx_callback = callback;
+        m_optiga_rx_context = context;
+    }
 
-    memcpy(pp_signature, temp, p_signature_len);
+    if (StartApdu(data, length, response, response_size))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
 
-    return IFX_I2C_STACK_SUCCESS;
+    /**
+     *  The HAL queues the completion of every I2C transfer and timer. Each event is delivered from this loop
+     *  and passes the layers once, so the stack does not grow with the number of frames of a transaction.
+     *  While the stack waits for a timer, the devices sharing the bus may use it.
+     */
+    m_bus_command_start = micros();
+    while (m_ifx_i2c_busy)
+    {
+        ifx_i2c_event_dispatch();
+        optiga_bus_share();
+    }
+    optiga_bus_command_done();
+    optiga_clock_track();
 
+    return FinishApdu();
 }
 
+/**
+ * This function hands the apdu to the transport layer and returns, the transaction is complete once m_ifx_i2c_busy is cleared
+ */
+uint16_t OPTIGATrustE::StartApdu(const uint8_t* data, uint16_t length, uint8_t* response, uint16_t response_size)
+{
+    // The stack serves one APDU at a time, reject nested or concurrent calls
+    if (optiga_stack_claim())
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    return optiga_stack_start(data, length, response, response_size);
+}
 
-uint16_t OPTIGATrustE::generalGetFunction(uint8_t* responseBuffer, uint32_t& responseLength, uint8_t tag, uint8_t OID)
+/**
+ * This function checks the response of the completed transaction
+ */
+uint16_t OPTIGATrustE::FinishApdu(void)
 {
-    uint8_t apdu[] = { HEADER_SPACE, tag, OID };
-    CreateHeader(apdu, OPTIGA_CMD_GET_DATA_OBJECT, OPTIGA_PARAM_READ_DATA, sizeof(apdu) - OPTIGA_CMD_HEADER_LEN);
-    if (SendApdu(apdu, sizeof(apdu)))
+    uint16_t response_len = 0;
+
+    if (m_optiga_rx_len < OPTIGA_CMD_HEADER_LEN)
     {
         return IFX_I2C_STACK_ERROR;
     }
-    uint32_t length = *(m_optiga_rx_buffer + 3);
-    if (length == 0)
+    if (m_optiga_rx_header[0] != OPTIGA_CMD_STATUS_SUCCESS)
     {
         return IFX_I2C_STACK_ERROR;
     }
-    memcpy(responseBuffer, (uint8_t*)(m_optiga_rx_buffer + OPTIGA_CMD_HEADER_LEN), length);
-    responseLength = length;
-
-    return IFX_I2C_STACK_SUCCESS;
-}
 
+    response_len = (m_optiga_rx_header[2] << 8) | m_optiga_rx_header[3];
+    if (OPTIGA_CMD_HEADER_LEN + response_len != m_optiga_rx_len)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
 
-uint16_t OPTIGATrustE::getLcsg(uint8_t responseBuffer[], uint32_t& responseLength)
-{
-    return generalGetFunction(responseBuffer, responseLength, OPTIGA_OID_TAG, LCS_G);
+    if (m_ifx_i2c_status == IFX_I2C_TL_EVENT_SUCCESS)
+    {
+        return IFX_I2C_STACK_SUCCESS;
+    }
+    else
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
 }
 
-uint16_t OPTIGATrustE::getGlobalSecurityStatus(uint8_t responseBuffer[], uint32_t& responseLength)
+uint16_t OPTIGATrustE::begin(void)
 {
-    return generalGetFunction(responseBuffer, responseLength, OPTIGA_OID_TAG, SECURITY_STATUS_G);
+    return begin(Wire);
 }
 
-uint16_t OPTIGATrustE::getCoprocessorId(uint8_t responseBuffer[], uint32_t& responseLength)
+uint16_t OPTIGATrustE::begin(TwoWire& CustomWire)
 {
-    return generalGetFunction(responseBuffer, responseLength, OPTIGA_OID_TAG, COPROCESSOR_UID);
+    if (beginAsync(CustomWire, 0))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    while (m_boot_state == OPTIGA_BOOT_START || m_boot_state == OPTIGA_BOOT_OPEN)
+    {
+        BootPoll();
+    }
+    return (m_boot_state == OPTIGA_BOOT_READY) ? IFX_I2C_STACK_SUCCESS : IFX_I2C_STACK_ERROR;
 }
 
-uint16_t OPTIGATrustE::getSleepModeActivationDelay(uint8_t responseBuffer[], uint32_t& responseLength)
+uint16_t OPTIGATrustE::beginAsync(void)
 {
-    return generalGetFunction(responseBuffer, responseLength, OPTIGA_OID_TAG, SLEEP_MODE_ACTIVATION_DELAY);
+    return beginAsync(Wire, OPTIGA_BOOT_TIMEOUT_MS);
 }
 
-uint16_t OPTIGATrustE::getCurrentLimitation(uint8_t responseBuffer[], uint32_t& responseLength)
+uint16_t OPTIGATrustE::beginAsync(TwoWire& CustomWire, uint32_t timeout_ms)
 {
-    return generalGetFunction(responseBuffer, responseLength, OPTIGA_OID_TAG, CURRENT_LIMITATION);
-}
+    // A command or another initialization is in progress
+    if (m_ifx_i2c_busy || m_boot_state == OPTIGA_BOOT_START || m_boot_state == OPTIGA_BOOT_OPEN)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
 
-uint16_t OPTIGATrustE::getSecurityEventCounter(uint8_t responseBuffer[], uint32_t& responseLength)
-{
-    return generalGetFunction(responseBuffer, responseLength, OPTIGA_OID_TAG, SECURITY_EVENT_COUNTER);
+    // Set global wire used with Optiga
+    OptigaWire = &CustomWire;
+
+    memset(&m_boot_timing, 0, sizeof(m_boot_timing));
+    m_boot_timeout_us = timeout_ms * 1000;
+    m_boot_start = micros();
+    m_boot_state = OPTIGA_BOOT_START;
+    m_auth_scheme_session = 0;
+    QueueRestart();
+    // The device may have changed meanwhile, or be another device
+    m_config_loaded = 0;
+    m_config_dirty = 0;
+    return IFX_I2C_STACK_SUCCESS;
 }
 
-uint16_t OPTIGATrustE::getLcsa(uint8_t responseBuffer[], uint32_t& responseLength)
+bool OPTIGATrustE::isReady(void)
 {
-    return generalGetFunction(responseBuffer, responseLength, OPTIGA_APP_TAG, LCS_A);
+    BootPoll();
+    return m_boot_state == OPTIGA_BOOT_READY;
 }
 
-uint16_t OPTIGATrustE::getAppSecurityStatus(uint8_t responseBuffer[], uint32_t& responseLength)
+void OPTIGATrustE::onReady(OPTIGATrustEReadyCallback callback, void* context)
 {
-    return generalGetFunction(responseBuffer, responseLength, OPTIGA_APP_TAG, SECURITY_STATUS_A);
+    m_boot_callback = callback;
+    m_boot_context = context;
+
+    // Initialization already finished, report it right away
+    if (callback != NULL && (m_boot_state == OPTIGA_BOOT_READY || m_boot_state == OPTIGA_BOOT_FAILED))
+    {
+        callback((m_boot_state == OPTIGA_BOOT_READY) ? IFX_I2C_STACK_SUCCESS : IFX_I2C_STACK_ERROR, context);
+    }
 }
 
-uint16_t OPTIGATrustE::getLastErrorCodes(uint8_t responseBuffer[], uint32_t& responseLength)
+void OPTIGATrustE::getBootTiming(OPTIGATrustEBootTiming& timing)
 {
-    return generalGetFunction(responseBuffer, responseLength, OPTIGA_APP_TAG, ERROR_CODES);
+    timing = m_boot_timing;
+}
+
+/**
+ * This function finishes the initialization and reports the result to the onReady callback
+ */
+static void optiga_boot_done(uint16_t status)
+{
+    m_boot_timing.total_us = micros() - m_boot_start;
+    m_boot_state = (status == IFX_I2C_STACK_SUCCESS) ? OPTIGA_BOOT_READY : OPTIGA_BOOT_FAILED;
+    if (m_boot_callback != NULL)
+    {
+        m_boot_callback(status, m_boot_context);
+    }
+}
+
+/**
+ * This function advances the initialization by one step, it does not wait for the device
+ */
+void OPTIGATrustE::BootPoll(void)
+{
+    if (m_boot_state == OPTIGA_BOOT_START)
+    {
+        // Start the Wire, the device is reset with the first frame of the open application command
+        if (ifx_i2c_tl_init(ifx_i2c_tl_event_handler) != IFX_I2C_STACK_SUCCESS)
+        {
+            optiga_boot_done(IFX_I2C_STACK_ERROR);
+            return;
+        }
+
+        // Keep the clock selected by probeClock, the Wire may have been set back to its default
+        if (m_clock_index != OPTIGA_CLOCK_UNMANAGED)
+        {
+            Wire_setClock(m_clock_rates[m_clock_index]);
+            optiga_clock_restart_window();
+        }
+
+        // The soft reset and the frame size are sent to the device with the first frame of the command
+        m_boot_phase_start = micros();
+        if (StartApdu(m_apdu_open_application, sizeof(m_apdu_open_application), NULL, 0))
+        {
+            optiga_boot_done(IFX_I2C_STACK_ERROR);
+            return;
+        }
+        m_boot_state = OPTIGA_BOOT_OPEN;
+        return;
+    }
+
+    if (m_boot_state != OPTIGA_BOOT_OPEN)
+    {
+        return;
+    }
+
+    if (m_ifx_i2c_busy)
+    {
+        ifx_i2c_event_dispatch();
+        if (m_boot_timing.soft_reset_us == 0 && ifx_i2c_pl_is_reset())
+        {
+            m_boot_timing.soft_reset_us = micros() - m_boot_start;
+            m_boot_phase_start = micros();
+        }
+        if (m_boot_timing.negotiation_us == 0 && ifx_i2c_pl_is_negotiated())
+        {
+            m_boot_timing.negotiation_us = micros() - m_boot_phase_start;
+            m_boot_phase_start = micros();
+        }
+        if (m_ifx_i2c_busy)
+        {
+            // Give up once the time limit is exceeded, begin() has no limit
+            if (m_boot_timeout_us && (uint32_t)(micros() - m_boot_start) > m_boot_timeout_us)
+            {
+                // Drop the transfer or timer of the HAL and the pending events, the layers start idle again
+                ifx_i2c_tl_init(ifx_i2c_tl_event_handler);
+                optiga_rx_reset_options();
+                m_ifx_i2c_busy = 0;
+                end();
+                optiga_boot_done(IFX_I2C_STACK_ERROR);
+            }
+            return;
+        }
+    }
+
+    optiga_clock_track();
+    m_boot_timing.open_application_us = micros() - m_boot_phase_start;
+    optiga_boot_done(FinishApdu());
+}
+
+/**
+ * This function re-synchronizes the transport and data link layer with the device and waits for completion
+ */
+uint16_t OPTIGATrustE::ResyncLink(void)
+{
+    if (optiga_stack_claim())
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    if (ifx_i2c_tl_resync())
+    {
+        m_ifx_i2c_busy = 0;
+        return IFX_I2C_STACK_ERROR;
+    }
+    while (m_ifx_i2c_busy)
+    {
+        ifx_i2c_event_dispatch();
+    }
+
+    return (m_ifx_i2c_status == IFX_I2C_TL_EVENT_SUCCESS) ? IFX_I2C_STACK_SUCCESS : IFX_I2C_STACK_ERROR;
+}
+
+/**
+ * This function records the outcome of one recovery tier
+ */
+static uint16_t optiga_recovery_done(uint8_t tier, uint32_t start, uint16_t status)
+{
+    m_recovery_stats.duration_us[tier] = micros() - start;
+    if (status == IFX_I2C_STACK_SUCCESS)
+    {
+        m_recovery_stats.count[tier]++;
+        m_recovery_stats.last_tier = tier + 1;
+    }
+    return status;
+}
+
+uint16_t OPTIGATrustE::recover(void)
+{
+    uint32_t start;
+    uint16_t status;
+
+    // Tier 1: resynchronize the frame counters, the application session is kept
+    start = micros();
+    status = ResyncLink();
+    if (status == IFX_I2C_STACK_SUCCESS)
+    {
+        status = SendApdu(m_apdu_get_uid, sizeof(m_apdu_get_uid), NULL, 0);
+    }
+    if (optiga_recovery_done(OPTIGA_RECOVERY_RESYNC, start, status) == IFX_I2C_STACK_SUCCESS)
+    {
+        return IFX_I2C_STACK_SUCCESS;
+    }
+
+    // Tier 2: open the application again, without resetting the device
+    start = micros();
+    status = ResyncLink();
+    if (status == IFX_I2C_STACK_SUCCESS)
+    {
+        m_auth_scheme_session = 0;
+        QueueRestart();
+        status = SendApdu(m_apdu_open_application, sizeof(m_apdu_open_application), NULL, 0);
+    }
+    if (status == IFX_I2C_STACK_SUCCESS && m_auth_scheme_set)
+    {
+        status = setAuthScheme();
+    }
+    if (optiga_recovery_done(OPTIGA_RECOVERY_REOPEN, start, status) == IFX_I2C_STACK_SUCCESS)
+    {
+        return IFX_I2C_STACK_SUCCESS;
+    }
+
+    // Tier 3: soft reset and full initialization
+    start = micros();
+    status = reset();
+    if (status == IFX_I2C_STACK_SUCCESS && m_auth_scheme_set)
+    {
+        status = setAuthScheme();
+    }
+    if (optiga_recovery_done(OPTIGA_RECOVERY_SOFT_RESET, start, status) == IFX_I2C_STACK_SUCCESS)
+    {
+        return IFX_I2C_STACK_SUCCESS;
+    }
+
+    m_recovery_stats.failures++;
+    m_recovery_stats.last_tier = 0;
+    return IFX_I2C_STACK_ERROR;
+}
+
+void OPTIGATrustE::getRecoveryStats(OPTIGATrustERecoveryStats& stats)
+{
+    stats = m_recovery_stats;
+}
+
+uint16_t OPTIGATrustE::begin(TwoWire& CustomWire, bool probe)
+{
+    if (begin(CustomWire))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    return probe ? probeClock() : IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t OPTIGATrustE::probeClock(void)
+{
+    uint8_t index;
+    uint8_t round;
+    uint16_t errors;
+
+    // No fallback while probing
+    m_clock_index = OPTIGA_CLOCK_UNMANAGED;
+
+    for (index = 0; index < OPTIGA_CLOCK_RATES_COUNT; index++)
+    {
+        Wire_setClock(m_clock_rates[index]);
+        errors = optiga_clock_dl_errors();
+
+        for (round = 0; round < OPTIGA_CLOCK_PROBE_ROUNDS; round++)
+        {
+            if (SendApdu(m_apdu_get_uid, sizeof(m_apdu_get_uid), NULL, 0))
+            {
+                break;
+            }
+        }
+
+        // Use the first clock without any data link error
+        if (round == OPTIGA_CLOCK_PROBE_ROUNDS && optiga_clock_dl_errors() == errors)
+        {
+            m_clock_index = index;
+            optiga_clock_restart_window();
+            return IFX_I2C_STACK_SUCCESS;
+        }
+
+        // A failed transaction leaves the stack out of sync, start again before trying the next clock
+        if (round < OPTIGA_CLOCK_PROBE_ROUNDS && reset())
+        {
+            return IFX_I2C_STACK_ERROR;
+        }
+    }
+    return IFX_I2C_STACK_ERROR;
+}
+
+uint32_t OPTIGATrustE::getClock(void)
+{
+    return (m_clock_index == OPTIGA_CLOCK_UNMANAGED) ? 0 : m_clock_rates[m_clock_index];
+}
+
+uint16_t OPTIGATrustE::reset(void)
+{
+	if(OptigaWire == NULL)
+	{
+        return IFX_I2C_STACK_ERROR;
+	}
+	
+    end();
+    return begin(*OptigaWire);
+}
+
+void OPTIGATrustE::end(void)
+{
+#ifdef WIRE_HAS_END
+    OptigaWire->end();
+#endif
+}
+
+
+uint16_t OPTIGATrustE::getCertificate(uint8_t pp_cert[], uint32_t& p_length)
+{
+    return getCertificate(pp_cert, OPTIGA_CERTIFICATE_MAX_LEN, p_length);
+}
+
+uint16_t OPTIGATrustE::getCertificate(uint8_t pp_cert[], uint16_t cert_size, uint32_t& p_length)
+{
+    // The sink stops copying at the end of the certificate, trailing bytes are dropped (reset by the handler)
+    m_optiga_rx_der = 1;
+    if (SendApdu(m_apdu_get_certificate, sizeof(m_apdu_get_certificate), pp_cert, cert_size)
+        || CertificateLength(p_length))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    // The certificate did not fit into the buffer
+    if (p_length > cert_size)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t OPTIGATrustE::getCertificate(OPTIGATrustEChunkCallback callback, void* context, uint32_t& p_length)
+{
+    if (callback == NULL)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    // The chunks are delivered from the transport layer fragments as they arrive (reset by the handler)
+    m_optiga_rx_der = 1;
+    m_optiga_rx_callback = callback;
+    m_optiga_rx_context = context;
+    if (SendApdu(m_apdu_get_certificate, sizeof(m_apdu_get_certificate), NULL, OPTIGA_CERTIFICATE_MAX_LEN)
+        || CertificateLength(p_length))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    // Chunks beyond the size of the certificate object are not delivered
+    if (p_length > OPTIGA_CERTIFICATE_MAX_LEN)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+/**
+ * This function determines the true length of the certificate in the last response without trailing zero bytes
+ */
+uint16_t OPTIGATrustE::CertificateLength(uint32_t& p_length)
+{
+    uint8_t* der = m_optiga_rx_header + OPTIGA_CMD_HEADER_LEN;
+
+    // ASN1 Sequence with ASN1 Extended Length UINT16
+    if (m_optiga_rx_len >= OPTIGA_CMD_HEADER_LEN + OPTIGA_DER_HEADER_LEN
+        && der[0] == 0x30 && der[1] == 0x82)
+    {
+        p_length = ((der[2] << 8) | der[3]) + OPTIGA_DER_HEADER_LEN;
+        if (p_length <= (uint32_t)(m_optiga_rx_len - OPTIGA_CMD_HEADER_LEN))
+        {
+            return IFX_I2C_STACK_SUCCESS;
+        }
+    }
+    return IFX_I2C_STACK_ERROR;
+}
+
+uint16_t OPTIGATrustE::getRandom(uint16_t length, uint8_t p_random[])
+{
+    uint8_t apdu[] = { OPTIGA_CMD_HEADER(OPTIGA_CMD_GET_RANDOM, 0x00, 2), (uint8_t)(length >> 8), (uint8_t)length };
+
+    if (p_random == NULL || length < 0x0008 || length > 0x100)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    if (SendApdu(apdu, sizeof(apdu), p_random, length))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    if (m_optiga_rx_len - OPTIGA_CMD_HEADER_LEN != length)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t OPTIGATrustE::setAuthScheme(void)
+{
+    // The scheme stays selected until the application is opened again
+    if (m_auth_scheme_session)
+    {
+        return IFX_I2C_STACK_SUCCESS;
+    }
+    if (SendApdu(m_apdu_set_auth_scheme, sizeof(m_apdu_set_auth_scheme), NULL, 0))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    m_auth_scheme_set = 1;
+    m_auth_scheme_session = 1;
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+/**
+ * This function sends the message to the device and reads the signature in DER format
+ */
+uint16_t OPTIGATrustE::SignMessage(uint8_t p_message[], uint16_t message_length,
+                                   uint8_t* signature, uint16_t signature_size)
+{
+    uint8_t apdu[OPTIGA_CMD_HEADER_LEN + OPTIGA_AUTH_MSG_LEN] =
+        { OPTIGA_CMD_HEADER(OPTIGA_CMD_SET_AUTH_MSG, OPTIGA_PARAM_CHALLENGE, OPTIGA_AUTH_MSG_LEN) };
+
+    if (message_length != OPTIGA_AUTH_MSG_LEN)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    memcpy(apdu + OPTIGA_CMD_HEADER_LEN, p_message, message_length);
+
+    // Selected once per application session, not with every signature
+    if (setAuthScheme())
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    // The device may have lost the scheme with a failed message or signature, it is selected again next time
+    if (SendApdu(apdu, sizeof(apdu), NULL, 0) ||
+        SendApdu(m_apdu_get_signature, sizeof(m_apdu_get_signature), signature, signature_size))
+    {
+        m_auth_scheme_session = 0;
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t OPTIGATrustE::getSignature(uint8_t p_message[], uint16_t message_length,
+        uint8_t pp_signature[], uint32_t& p_signature_len)
+{
+    return getSignature(p_message, message_length, pp_signature, OPTIGA_SIGNATURE_MAX_LEN, p_signature_len);
+}
+
+uint16_t OPTIGATrustE::getSignature(uint8_t p_message[], uint16_t message_length,
+        uint8_t pp_signature[], uint16_t signature_size, uint32_t& p_signature_len)
+{
+    if (SignMessage(p_message, message_length, pp_signature, signature_size))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    // The signature did not fit into the buffer
+    p_signature_len = m_optiga_rx_len - OPTIGA_CMD_HEADER_LEN;
+    if (p_signature_len > signature_size)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t OPTIGATrustE::getSignatureRaw(uint8_t p_message[], uint16_t message_length,
+                                       uint8_t signature[OPTIGA_SIGNATURE_RAW_LEN])
+{
+    uint8_t der[OPTIGA_SIGNATURE_MAX_LEN];
+
+    if (SignMessage(p_message, message_length, der, sizeof(der))
+        || m_optiga_rx_len > OPTIGA_CMD_HEADER_LEN + sizeof(der))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    return decodeSignature(der, m_optiga_rx_len - OPTIGA_CMD_HEADER_LEN, signature);
+}
+
+/**
+ * This function copies one DER INTEGER to a big endian number of OPTIGA_SIGNATURE_RAW_LEN / 2 bytes
+ * and returns the number of bytes consumed, 0 if the encoding is invalid
+ */
+static uint32_t optiga_der_integer(const uint8_t* der, uint32_t der_length, uint8_t* number)
+{
+    uint32_t consumed;
+    uint32_t length;
+    uint8_t  size = OPTIGA_SIGNATURE_RAW_LEN / 2;
+
+    // Short form length only, a P-256 signature never needs more
+    if (der_length < 2 || der[0] != 0x02 || der[1] == 0 || der[1] >= 0x80 || der[1] > der_length - 2)
+    {
+        return 0;
+    }
+    length = der[1];
+    consumed = 2 + length;
+    der += 2;
+
+    // A leading zero keeps numbers with the top bit set positive
+    while (length > size && der[0] == 0)
+    {
+        der++;
+        length--;
+    }
+    if (length > size)
+    {
+        return 0;
+    }
+    memset(number, 0, size - length);
+    memcpy(number + size - length, der, length);
+
+    return consumed;
+}
+
+uint16_t OPTIGATrustE::decodeSignature(const uint8_t der[], uint32_t der_length,
+                                       uint8_t signature[OPTIGA_SIGNATURE_RAW_LEN])
+{
+    uint32_t length;
+    uint32_t consumed;
+
+    if (der == NULL || signature == NULL)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    // SEQUENCE { INTEGER r, INTEGER s }
+    if (der_length < 2 || der[0] != 0x30 || der[1] >= 0x80 || der[1] != der_length - 2)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    der += 2;
+    length = der_length - 2;
+
+    consumed = optiga_der_integer(der, length, signature);
+    if (consumed == 0)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    der += consumed;
+    length -= consumed;
+
+    consumed = optiga_der_integer(der, length, signature + OPTIGA_SIGNATURE_RAW_LEN / 2);
+    if (consumed == 0 || consumed != length)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+
+uint16_t OPTIGATrustE::verifyCertificate(uint8_t certificate[], uint32_t& length,
+                                         OPTIGATrustEVerifyCallback verify, OPTIGATrustEVerdict& verdict)
+{
+    uint8_t  uid[OPTIGA_UID_LEN];
+    uint8_t  key[SHA256_DIGEST_LEN];
+    uint8_t  digest[SHA256_DIGEST_LEN];
+    uint8_t  signature[OPTIGA_SIGNATURE_RAW_LEN];
+    uint32_t uidLength;
+    const uint8_t* field;
+    uint16_t fieldLength;
+    sha256_context_t sha;
+
+    if (getCertificate(certificate, length)
+        || readObject(OPTIGA_OID_TAG, COPROCESSOR_UID, 0, sizeof(uid), uid, uidLength))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    // The verdict holds for this certificate on this device only
+    sha256_init(&sha);
+    sha256_update(&sha, certificate, length);
+    sha256_update(&sha, uid, uidLength);
+    sha256_final(&sha, key);
+    if (verdict.valid && memcmp(verdict.digest, key, sizeof(key)) == 0)
+    {
+        return IFX_I2C_STACK_SUCCESS;
+    }
+    verdict.valid = 0;
+
+    OPTIGATrustECertificate view(certificate, length);
+    if (verify == NULL
+        || view.getContent(OPTIGA_CERT_SIGNATURE_ALGORITHM, field, fieldLength)
+        || fieldLength != sizeof(m_ecdsa_with_sha256)
+        || memcmp(field, m_ecdsa_with_sha256, sizeof(m_ecdsa_with_sha256)) != 0
+        || view.getSignature(field, fieldLength)
+        || decodeSignature(field, fieldLength, signature)
+        || view.getElement(OPTIGA_CERT_TBS, field, fieldLength))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    sha256_init(&sha);
+    sha256_update(&sha, field, fieldLength);
+    sha256_final(&sha, digest);
+    if (!verify(m_ca_public_key, digest, signature))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    memcpy(verdict.digest, key, sizeof(key));
+    verdict.valid = 1;
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t OPTIGATrustE::transceive(uint8_t apdu[], uint16_t length, uint8_t response[], uint16_t responseSize,
+                                  uint32_t& responseLength)
+{
+    if (apdu == NULL || length < OPTIGA_CMD_HEADER_LEN)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    if (response == NULL)
+    {
+        responseSize = 0;
+    }
+    // A new application session starts without an auth scheme
+    if (OPTIGA_CMD_IS_OPEN_APPLICATION(apdu))
+    {
+        m_auth_scheme_session = 0;
+    }
+
+    if (SendApdu(apdu, length, response, responseSize))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    // The response did not fit into the buffer, only responseSize bytes were copied
+    responseLength = m_optiga_rx_len - OPTIGA_CMD_HEADER_LEN;
+    if (responseLength > responseSize)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+/**
+ * This function copies a filled in entry to a free place of the queue. Commands may be queued from another task
+ * or an interrupt, so the entry is copied under the lock and poll only sees complete entries.
+ */
+static uint16_t optiga_queue_add(optiga_queue_entry_t* entry, uint8_t kind, uint8_t priority,
+                                 OPTIGATrustECommandCallback callback, void* context)
+{
+    uint8_t i;
+
+    if (priority >= OPTIGA_PRIORITY_COUNT)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    entry->kind = kind;
+    entry->priority = priority;
+    entry->queued_us = micros();
+    entry->callback = callback;
+    entry->context = context;
+
+    OPTIGA_QUEUE_LOCK();
+    for (i = 0; i < OPTIGA_QUEUE_SIZE; i++)
+    {
+        if (m_queue[i].kind == OPTIGA_QUEUE_FREE)
+        {
+            entry->sequence = m_queue_sequence++;
+            m_queue[i] = *entry;
+            OPTIGA_QUEUE_UNLOCK();
+            return IFX_I2C_STACK_SUCCESS;
+        }
+    }
+    OPTIGA_QUEUE_UNLOCK();
+
+    return IFX_I2C_STACK_ERROR;
+}
+
+/**
+ * This function returns the queued entry to serve next, the highest priority class first and the oldest within a class.
+ * Called under the lock.
+ */
+static uint8_t optiga_queue_next(void)
+{
+    uint8_t next = OPTIGA_QUEUE_NONE;
+    uint8_t i;
+
+    for (i = 0; i < OPTIGA_QUEUE_SIZE; i++)
+    {
+        if (m_queue[i].kind == OPTIGA_QUEUE_FREE)
+        {
+            continue;
+        }
+        if (next == OPTIGA_QUEUE_NONE || m_queue[i].priority < m_queue[next].priority
+            || (m_queue[i].priority == m_queue[next].priority
+                && (int32_t)(m_queue[i].sequence - m_queue[next].sequence) < 0))
+        {
+            next = i;
+        }
+    }
+    return next;
+}
+
+/**
+ * This function removes the current entry from the queue, counts its latency and calls its callback
+ */
+static void optiga_queue_done(uint16_t status)
+{
+    optiga_queue_entry_t entry = m_queue[m_queue_current];
+    OPTIGATrustEQueueStats* stats = &m_queue_stats[entry.priority];
+    uint32_t latency = micros() - entry.queued_us;
+
+    // The entry is free before the callback runs, the callback may queue the next command
+    OPTIGA_QUEUE_LOCK();
+    m_queue[m_queue_current].kind = OPTIGA_QUEUE_FREE;
+    m_queue_current = OPTIGA_QUEUE_NONE;
+    OPTIGA_QUEUE_UNLOCK();
+
+    if (status == IFX_I2C_STACK_SUCCESS)
+    {
+        stats->completed++;
+    }
+    else
+    {
+        stats->failed++;
+    }
+    if (stats->target_us != 0 && latency > stats->target_us)
+    {
+        stats->missed++;
+    }
+    if (latency > stats->max_us)
+    {
+        stats->max_us = latency;
+    }
+    stats->total_us += latency;
+
+    if (entry.callback != NULL)
+    {
+        entry.callback(status, entry.length, entry.context);
+    }
+}
+
+/**
+ * This function returns the number of bytes of the next chunk of a queued data object read
+ */
+static uint16_t optiga_queue_chunk(const optiga_queue_entry_t* entry)
+{
+    uint16_t chunk = entry->size - entry->length;
+
+    return (chunk > OPTIGA_QUEUE_READ_CHUNK) ? OPTIGA_QUEUE_READ_CHUNK : chunk;
+}
+
+uint16_t OPTIGATrustE::queueSignature(uint8_t priority, uint8_t p_message[], uint16_t message_length,
+                                      uint8_t pp_signature[], uint16_t signature_size,
+                                      OPTIGATrustECommandCallback callback, void* context)
+{
+    optiga_queue_entry_t entry;
+
+    if (p_message == NULL || message_length != OPTIGA_AUTH_MSG_LEN || pp_signature == NULL)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    memset(&entry, 0, sizeof(entry));
+    memcpy(entry.message, p_message, message_length);
+    entry.response = pp_signature;
+    entry.size = signature_size;
+    return optiga_queue_add(&entry, OPTIGA_QUEUE_SIGNATURE, priority, callback, context);
+}
+
+uint16_t OPTIGATrustE::queueReadObject(uint8_t priority, uint8_t tag, uint8_t OID, uint16_t offset, uint16_t length,
+                                       uint8_t responseBuffer[], OPTIGATrustECommandCallback callback, void* context)
+{
+    optiga_queue_entry_t entry;
+
+    if (responseBuffer == NULL || length == 0)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    memset(&entry, 0, sizeof(entry));
+    entry.tag = tag;
+    entry.OID = OID;
+    entry.offset = offset;
+    entry.response = responseBuffer;
+    entry.size = length;
+    return optiga_queue_add(&entry, OPTIGA_QUEUE_READ, priority, callback, context);
+}
+
+uint16_t OPTIGATrustE::queueTransceive(uint8_t priority, const uint8_t apdu[], uint16_t length,
+                                       uint8_t response[], uint16_t responseSize,
+                                       OPTIGATrustECommandCallback callback, void* context)
+{
+    optiga_queue_entry_t entry;
+
+    if (apdu == NULL || length < OPTIGA_CMD_HEADER_LEN)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    memset(&entry, 0, sizeof(entry));
+    entry.apdu = apdu;
+    entry.apdu_length = length;
+    entry.response = response;
+    entry.size = (response != NULL) ? responseSize : 0;
+    return optiga_queue_add(&entry, OPTIGA_QUEUE_TRANSCEIVE, priority, callback, context);
+}
+
+bool OPTIGATrustE::poll(void)
+{
+    bool pending = false;
+    uint8_t i;
+
+    // The queue is served by one context at a time, poll() called meanwhile from another one returns
+    OPTIGA_QUEUE_LOCK();
+    if (m_queue_polling)
+    {
+        OPTIGA_QUEUE_UNLOCK();
+        return true;
+    }
+    m_queue_polling = 1;
+    OPTIGA_QUEUE_UNLOCK();
+
+    // Commands wait for an initialization started with beginAsync
+    if (m_boot_state == OPTIGA_BOOT_START || m_boot_state == OPTIGA_BOOT_OPEN)
+    {
+        BootPoll();
+    }
+    else if (m_queue_sending)
+    {
+        if (m_ifx_i2c_busy)
+        {
+            ifx_i2c_event_dispatch();
+        }
+        if (!m_ifx_i2c_busy)
+        {
+            optiga_clock_track();
+            QueueComplete(FinishApdu());
+        }
+    }
+    else
+    {
+        // The entry of a signature stays current between its two commands
+        if (m_queue_current == OPTIGA_QUEUE_NONE)
+        {
+            OPTIGA_QUEUE_LOCK();
+            m_queue_current = optiga_queue_next();
+            OPTIGA_QUEUE_UNLOCK();
+        }
+        if (m_queue_current != OPTIGA_QUEUE_NONE)
+        {
+            if (m_boot_state == OPTIGA_BOOT_FAILED)
+            {
+                optiga_queue_done(IFX_I2C_STACK_ERROR);
+            }
+            else
+            {
+                QueueStart();
+            }
+        }
+    }
+
+    for (i = 0; i < OPTIGA_QUEUE_SIZE; i++)
+    {
+        if (m_queue[i].kind != OPTIGA_QUEUE_FREE)
+        {
+            pending = true;
+        }
+    }
+    m_queue_polling = 0;
+    return pending;
+}
+
+/**
+ * This function starts the next command of the current queue entry
+ */
+void OPTIGATrustE::QueueStart(void)
+{
+    optiga_queue_entry_t* entry = &m_queue[m_queue_current];
+    const uint8_t* apdu = m_queue_apdu;
+    uint16_t apdu_length;
+    uint8_t* response = entry->response;
+    uint16_t response_size = entry->size;
+    uint16_t position;
+
+    // A blocking command of another context holds the stack, the entry stays current and is started later
+    if (optiga_stack_claim())
+    {
+        return;
+    }
+
+    if (entry->kind == OPTIGA_QUEUE_TRANSCEIVE)
+    {
+        apdu = entry->apdu;
+        apdu_length = entry->apdu_length;
+        // A new application session starts without an auth scheme
+        if (OPTIGA_CMD_IS_OPEN_APPLICATION(apdu))
+        {
+            m_auth_scheme_session = 0;
+        }
+    }
+    else if (entry->kind == OPTIGA_QUEUE_READ)
+    {
+        position = entry->offset + entry->length;
+        response_size = optiga_queue_chunk(entry);
+        response += entry->length;
+        CreateHeader(m_queue_apdu, OPTIGA_CMD_GET_DATA_OBJECT, OPTIGA_PARAM_READ_DATA, 6);
+        m_queue_apdu[4] = entry->tag;
+        m_queue_apdu[5] = entry->OID;
+        m_queue_apdu[6] = position >> 8;
+        m_queue_apdu[7] = position;
+        m_queue_apdu[8] = response_size >> 8;
+        m_queue_apdu[9] = response_size;
+        apdu_length = OPTIGA_CMD_HEADER_LEN + 6;
+    }
+    else if (entry->step == OPTIGA_QUEUE_STEP_SCHEME && !m_auth_scheme_session)
+    {
+        apdu = m_apdu_set_auth_scheme;
+        apdu_length = sizeof(m_apdu_set_auth_scheme);
+        response = NULL;
+        response_size = 0;
+    }
+    else if (entry->step != OPTIGA_QUEUE_STEP_SIGNATURE)
+    {
+        entry->step = OPTIGA_QUEUE_STEP_MESSAGE;
+        CreateHeader(m_queue_apdu, OPTIGA_CMD_SET_AUTH_MSG, OPTIGA_PARAM_CHALLENGE, OPTIGA_AUTH_MSG_LEN);
+        memcpy(m_queue_apdu + OPTIGA_CMD_HEADER_LEN, entry->message, OPTIGA_AUTH_MSG_LEN);
+        apdu_length = OPTIGA_CMD_HEADER_LEN + OPTIGA_AUTH_MSG_LEN;
+        response = NULL;
+        response_size = 0;
+    }
+    else
+    {
+        apdu = m_apdu_get_signature;
+        apdu_length = sizeof(m_apdu_get_signature);
+    }
+
+    if (optiga_stack_start(apdu, apdu_length, response, response_size))
+    {
+        optiga_queue_done(IFX_I2C_STACK_ERROR);
+        return;
+    }
+    m_queue_sending = 1;
+}
+
+/**
+ * This function processes the response of the current queue entry
+ */
+void OPTIGATrustE::QueueComplete(uint16_t status)
+{
+    optiga_queue_entry_t* entry = &m_queue[m_queue_current];
+    uint16_t received = m_optiga_rx_len - OPTIGA_CMD_HEADER_LEN;
+    uint16_t chunk;
+
+    m_queue_sending = 0;
+    if (status != IFX_I2C_STACK_SUCCESS)
+    {
+        // The device may have lost the scheme with a failed message or signature, it is selected again next time
+        if (entry->kind == OPTIGA_QUEUE_SIGNATURE && entry->step != OPTIGA_QUEUE_STEP_SCHEME)
+        {
+            m_auth_scheme_session = 0;
+        }
+        optiga_queue_done(IFX_I2C_STACK_ERROR);
+        return;
+    }
+
+    if (entry->kind == OPTIGA_QUEUE_SIGNATURE && entry->step != OPTIGA_QUEUE_STEP_SIGNATURE)
+    {
+        if (entry->step == OPTIGA_QUEUE_STEP_SCHEME)
+        {
+            m_auth_scheme_set = 1;
+            m_auth_scheme_session = 1;
+        }
+        // The next command of the signature follows, no other command may change the scheme or the message in between
+        entry->step++;
+        return;
+    }
+
+    if (entry->kind != OPTIGA_QUEUE_READ)
+    {
+        // The response did not fit into the buffer
+        if (received > entry->size)
+        {
+            optiga_queue_done(IFX_I2C_STACK_ERROR);
+            return;
+        }
+        entry->length = received;
+        optiga_queue_done(IFX_I2C_STACK_SUCCESS);
+        return;
+    }
+
+    chunk = optiga_queue_chunk(entry);
+    if (received > chunk)
+    {
+        optiga_queue_done(IFX_I2C_STACK_ERROR);
+        return;
+    }
+    entry->length += received;
+    if (received < chunk || entry->length == entry->size)
+    {
+        // Complete, or the data object ended
+        optiga_queue_done(IFX_I2C_STACK_SUCCESS);
+        return;
+    }
+
+    // Back to the queue, queued commands of a higher priority class are sent before the next chunk
+    m_queue_current = OPTIGA_QUEUE_NONE;
+}
+
+/**
+ * This function restarts or aborts the current queue entry when a new application session starts
+ */
+void OPTIGATrustE::QueueRestart(void)
+{
+    if (m_queue_current == OPTIGA_QUEUE_NONE)
+    {
+        return;
+    }
+
+    // The response of a command sent in the earlier session is lost with the initialization
+    if (m_queue_sending)
+    {
+        m_queue_sending = 0;
+        optiga_queue_done(IFX_I2C_STACK_ERROR);
+    }
+    // A signature between its commands selects the scheme of the new session first
+    else if (m_queue[m_queue_current].kind == OPTIGA_QUEUE_SIGNATURE)
+    {
+        m_queue[m_queue_current].step = OPTIGA_QUEUE_STEP_SCHEME;
+    }
+}
+
+void OPTIGATrustE::setLatencyTarget(uint8_t priority, uint32_t target_us)
+{
+    if (priority < OPTIGA_PRIORITY_COUNT)
+    {
+        m_queue_stats[priority].target_us = target_us;
+    }
+}
+
+void OPTIGATrustE::getQueueStats(uint8_t priority, OPTIGATrustEQueueStats& stats, bool reset)
+{
+    uint32_t target_us;
+
+    if (priority >= OPTIGA_PRIORITY_COUNT)
+    {
+        memset(&stats, 0, sizeof(stats));
+        return;
+    }
+    stats = m_queue_stats[priority];
+    if (reset)
+    {
+        target_us = m_queue_stats[priority].target_us;
+        memset(&m_queue_stats[priority], 0, sizeof(m_queue_stats[priority]));
+        m_queue_stats[priority].target_us = target_us;
+    }
+}
+
+uint16_t OPTIGATrustE::shareBus(OPTIGATrustEBusCallback callback, void* context, uint32_t duration_us, uint8_t& device)
+{
+    optiga_bus_device_t* entry;
+
+    if (callback == NULL || m_bus_device_count >= OPTIGA_BUS_DEVICES_MAX)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    entry = &m_bus_devices[m_bus_device_count];
+    memset(entry, 0, sizeof(*entry));
+    entry->callback = callback;
+    entry->context = context;
+    entry->duration_us = duration_us;
+    entry->last_us = micros();
+    entry->reset_us = entry->last_us;
+    device = m_bus_device_count++;
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+void OPTIGATrustE::getBusStats(uint8_t device, OPTIGATrustEBusStats& stats, bool reset)
+{
+    uint32_t now = micros();
+
+    memset(&stats, 0, sizeof(stats));
+    if (device == OPTIGA_BUS_OPTIGA)
+    {
+        stats.transactions = m_bus_optiga_commands;
+        stats.busy_us = ifx_i2c_hal_bus_us() - m_bus_optiga_base_us;
+        stats.period_us = now - m_bus_optiga_reset_us;
+        if (reset)
+        {
+            m_bus_optiga_commands = 0;
+            m_bus_optiga_base_us += stats.busy_us;
+            m_bus_optiga_reset_us = now;
+        }
+    }
+    else if (device < m_bus_device_count)
+    {
+        stats = m_bus_devices[device].stats;
+        stats.period_us = now - m_bus_devices[device].reset_us;
+        if (reset)
+        {
+            memset(&m_bus_devices[device].stats, 0, sizeof(m_bus_devices[device].stats));
+            m_bus_devices[device].reset_us = now;
+        }
+    }
+}
+
+/**
+ * This function returns the index of a configuration object in the shadow or OPTIGA_CONFIG_NONE
+ */
+static uint8_t optiga_config_index(uint8_t tag, uint8_t OID)
+{
+    uint8_t i;
+
+    if (!m_config_loaded)
+    {
+        return OPTIGA_CONFIG_NONE;
+    }
+    for (i = 0; i < OPTIGA_CONFIG_COUNT; i++)
+    {
+        if (m_config_objects[i][0] == tag && m_config_objects[i][1] == OID)
+        {
+            return i;
+        }
+    }
+    return OPTIGA_CONFIG_NONE;
+}
+
+uint16_t OPTIGATrustE::generalGetFunction(uint8_t* responseBuffer, uint16_t responseSize, uint32_t& responseLength,
+                                          uint8_t tag, uint8_t OID)
+{
+    if (responseBuffer == NULL || responseSize == 0)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    uint8_t index = optiga_config_index(tag, OID);
+    if (index != OPTIGA_CONFIG_NONE)
+    {
+        responseBuffer[0] = m_config_value[index];
+        responseLength = 1;
+        return IFX_I2C_STACK_SUCCESS;
+    }
+
+    uint8_t apdu[] = { OPTIGA_CMD_HEADER(OPTIGA_CMD_GET_DATA_OBJECT, OPTIGA_PARAM_READ_DATA, 2), tag, OID };
+    if (SendApdu(apdu, sizeof(apdu), responseBuffer, responseSize))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    // The value did not fit into the buffer
+    uint32_t length = (m_optiga_rx_header[2] << 8) | m_optiga_rx_header[3];
+    if (length == 0 || length > responseSize)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    responseLength = length;
+
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t OPTIGATrustE::readObject(uint8_t tag, uint8_t OID, uint16_t offset, uint16_t length,
+                                  uint8_t responseBuffer[], uint32_t& responseLength)
+{
+    uint8_t apdu[] = { OPTIGA_CMD_HEADER(OPTIGA_CMD_GET_DATA_OBJECT, OPTIGA_PARAM_READ_DATA, 6), tag, OID,
+                       (uint8_t)(offset >> 8), (uint8_t)offset, (uint8_t)(length >> 8), (uint8_t)length };
+
+    if (responseBuffer == NULL || length == 0)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    // The device returns less data if the object ends before offset + length
+    if (SendApdu(apdu, sizeof(apdu), responseBuffer, length))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    responseLength = m_optiga_rx_len - OPTIGA_CMD_HEADER_LEN;
+    if (responseLength > length)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+
+uint16_t OPTIGATrustE::getLcsg(uint8_t responseBuffer[], uint32_t& responseLength)
+{
+    return generalGetFunction(responseBuffer, OPTIGA_OBJECT_BYTE_LEN, responseLength, OPTIGA_OID_TAG, LCS_G);
+}
+
+uint16_t OPTIGATrustE::getGlobalSecurityStatus(uint8_t responseBuffer[], uint32_t& responseLength)
+{
+    return generalGetFunction(responseBuffer, OPTIGA_OBJECT_BYTE_LEN, responseLength, OPTIGA_OID_TAG, SECURITY_STATUS_G);
+}
+
+uint16_t OPTIGATrustE::getCoprocessorId(uint8_t responseBuffer[], uint32_t& responseLength)
+{
+    return generalGetFunction(responseBuffer, OPTIGA_UID_LEN, responseLength, OPTIGA_OID_TAG, COPROCESSOR_UID);
+}
+
+uint16_t OPTIGATrustE::getCoprocessorId(uint8_t responseBuffer[], uint16_t responseSize, uint32_t& responseLength)
+{
+    return generalGetFunction(responseBuffer, responseSize, responseLength, OPTIGA_OID_TAG, COPROCESSOR_UID);
+}
+
+uint16_t OPTIGATrustE::getSleepModeActivationDelay(uint8_t responseBuffer[], uint32_t& responseLength)
+{
+    return generalGetFunction(responseBuffer, OPTIGA_OBJECT_BYTE_LEN, responseLength, OPTIGA_OID_TAG, SLEEP_MODE_ACTIVATION_DELAY);
+}
+
+uint16_t OPTIGATrustE::getCurrentLimitation(uint8_t responseBuffer[], uint32_t& responseLength)
+{
+    return generalGetFunction(responseBuffer, OPTIGA_OBJECT_BYTE_LEN, responseLength, OPTIGA_OID_TAG, CURRENT_LIMITATION);
+}
+
+uint16_t OPTIGATrustE::getSecurityEventCounter(uint8_t responseBuffer[], uint32_t& responseLength)
+{
+    return generalGetFunction(responseBuffer, OPTIGA_OBJECT_BYTE_LEN, responseLength, OPTIGA_OID_TAG, SECURITY_EVENT_COUNTER);
+}
+
+uint16_t OPTIGATrustE::getLcsa(uint8_t responseBuffer[], uint32_t& responseLength)
+{
+    return generalGetFunction(responseBuffer, OPTIGA_OBJECT_BYTE_LEN, responseLength, OPTIGA_APP_TAG, LCS_A);
+}
+
+uint16_t OPTIGATrustE::getAppSecurityStatus(uint8_t responseBuffer[], uint32_t& responseLength)
+{
+    return generalGetFunction(responseBuffer, OPTIGA_OBJECT_BYTE_LEN, responseLength, OPTIGA_APP_TAG, SECURITY_STATUS_A);
+}
+
+uint16_t OPTIGATrustE::getLastErrorCodes(uint8_t responseBuffer[], uint32_t& responseLength)
+{
+    return generalGetFunction(responseBuffer, OPTIGA_ERROR_CODES_MAX_LEN, responseLength, OPTIGA_APP_TAG, ERROR_CODES);
+}
+
+uint16_t OPTIGATrustE::getLastErrorCodes(uint8_t responseBuffer[], uint16_t responseSize, uint32_t& responseLength)
+{
+    return generalGetFunction(responseBuffer, responseSize, responseLength, OPTIGA_APP_TAG, ERROR_CODES);
 }
 
 //for the project specific device public key certificate, the OPTIGA return 01234......6401234.....64..... until the recieving buffer of the transport layer is full.
 
 uint16_t OPTIGATrustE::generalSetFunction(uint8_t* dataToSet, uint32_t length, uint8_t tag, uint8_t OID)
 {
-    //this length is based on the length of the header, the length of the data to set and the length of the write offset, tag and oid (which is 4)
-    uint32_t apduLength = (uint32_t)OPTIGA_CMD_HEADER_LEN + length + (uint32_t)4 ;
-    uint8_t apdu[apduLength];
-    CreateHeader(apdu, OPTIGA_CMD_SET_DATA_OBJECT, OPTIGA_PARAM_WRITE_DATA, sizeof(apdu) - OPTIGA_CMD_HEADER_LEN);
+    uint32_t offset = 0;
+    uint8_t index = optiga_config_index(tag, OID);
 
-    //initialize the tag,oid and the write offset on the apdu that will be sent
-    apdu[4] = tag;
-    apdu[5] = OID;
-    apdu[6] = 0x00;
-    apdu[7] = 0x00;
+    // With a loaded shadow the value is written by commitConfig, and only if it changed
+    if (index != OPTIGA_CONFIG_NONE && dataToSet != NULL && length == 1)
+    {
+        if (m_config_value[index] != dataToSet[0])
+        {
+            m_config_value[index] = dataToSet[0];
+            m_config_dirty |= 1 << index;
+        }
+        return IFX_I2C_STACK_SUCCESS;
+    }
+
+    return writeObject(tag, OID, dataToSet, length, offset);
+}
 
-    //we give apdu + 8 here because the headers initialized above take up the index from 0 to 7. We copy the data provided in dataToSet to the apdu that we send to the Optiga Trust E
-    memcpy(apdu + 8, dataToSet, length);
+uint16_t OPTIGATrustE::writeObject(uint8_t tag, uint8_t OID, uint8_t dataToWrite[], uint32_t length, uint32_t& offset)
+{
+    //the apdu holds the header, the tag, oid and write offset (which is 4) and one chunk of the data
+    uint8_t apdu[OPTIGA_CMD_HEADER_LEN + OPTIGA_SET_DATA_HEADER_LEN + OPTIGA_WRITE_CHUNK_SIZE];
+    uint16_t chunkLength;
+    uint16_t chunkSize;
+
+    if (dataToWrite == NULL || offset > length || length > 0xFFFF)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
 
-    if (SendApdu(apdu, sizeof(apdu)))
+    //the frame size might be below DL_MAX_FRAME_SIZE, size the chunks for the fragments actually used
+    chunkSize = OPTIGA_WRITE_CHUNK_FRAGMENTS * (ifx_i2c_dl_get_max_payload() - 1);
+    if (chunkSize <= OPTIGA_CMD_HEADER_LEN + OPTIGA_SET_DATA_HEADER_LEN)
     {
         return IFX_I2C_STACK_ERROR;
     }
+    chunkSize -= OPTIGA_CMD_HEADER_LEN + OPTIGA_SET_DATA_HEADER_LEN;
+
+    //initialize the tag and oid on the apdu that will be sent
+    apdu[4] = tag;
+    apdu[5] = OID;
+
+    do
+    {
+        chunkLength = chunkSize;
+        if (offset + chunkLength > length)
+        {
+            chunkLength = length - offset;
+        }
+
+        CreateHeader(apdu, OPTIGA_CMD_SET_DATA_OBJECT, OPTIGA_PARAM_WRITE_DATA,
+                           OPTIGA_SET_DATA_HEADER_LEN + chunkLength);
+        apdu[6] = offset >> 8;
+        apdu[7] = offset;
+
+        //we give apdu + 8 here because the headers initialized above take up the index from 0 to 7
+        memcpy(apdu + 8, dataToWrite + offset, chunkLength);
+
+        if (SendApdu(apdu, OPTIGA_CMD_HEADER_LEN + OPTIGA_SET_DATA_HEADER_LEN + chunkLength, NULL, 0))
+        {
+            //offset still points to the first byte not acknowledged by the device
+            return IFX_I2C_STACK_ERROR;
+        }
+        offset += chunkLength;
+    } while (offset < length);
 
     return IFX_I2C_STACK_SUCCESS;
 }
@@ -454,6 +2054,104 @@ uint16_t OPTIGATrustE::setCurrentLimitation(uint8_t dataToSet[])
     return generalSetFunction(dataToSet, (uint32_t)1, OPTIGA_OID_TAG,  CURRENT_LIMITATION);
 }
 
+/**
+ * This function adds one measurement to the latency of a command
+ */
+static void optiga_latency_add(OPTIGATrustELatency& latency, uint32_t duration_us, uint8_t round)
+{
+    if (round == 0 || duration_us < latency.min_us)
+    {
+        latency.min_us = duration_us;
+    }
+    if (round == 0 || duration_us > latency.max_us)
+    {
+        latency.max_us = duration_us;
+    }
+    // Running average, exact for the number of rounds measured so far
+    latency.avg_us = (uint32_t)(((uint64_t)latency.avg_us * round + duration_us) / (round + 1));
+}
+
+uint16_t OPTIGATrustE::calibrateCurrentLimitation(OPTIGATrustECurrentProfile& profile, uint8_t rounds)
+{
+    uint8_t  original;
+    uint8_t  limit;
+    uint8_t  round;
+    uint8_t  challenge[OPTIGA_AUTH_MSG_LEN];
+    uint8_t  signature[OPTIGA_SIGNATURE_MAX_LEN];
+    uint32_t length;
+    uint32_t offset;
+    uint32_t start;
+    uint16_t status = IFX_I2C_STACK_SUCCESS;
+
+    if (rounds == 0)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    // Measure and restore the device itself, a loaded configuration shadow is not touched
+    if (readObject(OPTIGA_OID_TAG, CURRENT_LIMITATION, 0, 1, &original, length) || length != 1)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    // Selected before the measurement, the first signature would include it otherwise
+    if (setAuthScheme())
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    memset(&profile, 0, sizeof(profile));
+    for (limit = OPTIGA_CURRENT_LIMIT_MIN; limit <= OPTIGA_CURRENT_LIMIT_MAX && !status; limit++)
+    {
+        OPTIGATrustELatency& random_latency = profile.random[limit - OPTIGA_CURRENT_LIMIT_MIN];
+        OPTIGATrustELatency& signature_latency = profile.signature[limit - OPTIGA_CURRENT_LIMIT_MIN];
+
+        offset = 0;
+        status = writeObject(OPTIGA_OID_TAG, CURRENT_LIMITATION, &limit, 1, offset);
+        for (round = 0; round < rounds && !status; round++)
+        {
+            // The random number is used as the challenge of the signature
+            start = micros();
+            status = getRandom(sizeof(challenge), challenge);
+            optiga_latency_add(random_latency, micros() - start, round);
+            if (status)
+            {
+                break;
+            }
+
+            start = micros();
+            status = getSignature(challenge, sizeof(challenge), signature, length);
+            optiga_latency_add(signature_latency, micros() - start, round);
+        }
+    }
+
+    // Leave the device as it was found, even if a measurement failed
+    offset = 0;
+    if (writeObject(OPTIGA_OID_TAG, CURRENT_LIMITATION, &original, 1, offset) || status)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    profile.rounds = rounds;
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t OPTIGATrustE::applyCurrentLimitation(const OPTIGATrustECurrentProfile& profile, uint32_t max_signature_us)
+{
+    uint8_t limit;
+
+    if (profile.rounds == 0)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    for (limit = OPTIGA_CURRENT_LIMIT_MIN; limit <= OPTIGA_CURRENT_LIMIT_MAX; limit++)
+    {
+        if (profile.signature[limit - OPTIGA_CURRENT_LIMIT_MIN].max_us <= max_signature_us)
+        {
+            return setCurrentLimitation(&limit);
+        }
+    }
+    return IFX_I2C_STACK_ERROR;
+}
+
 uint16_t OPTIGATrustE::setLcsa(uint8_t dataToSet[])
 {
     return generalSetFunction(dataToSet, (uint32_t)1, OPTIGA_APP_TAG,  LCS_A);
@@ -464,6 +2162,52 @@ uint16_t OPTIGATrustE::setAppSecurityStatus(uint8_t dataToSet[])
     return generalSetFunction(dataToSet, (uint32_t)1, OPTIGA_APP_TAG,  SECURITY_STATUS_A);
 }
 
+uint16_t OPTIGATrustE::loadConfig(void)
+{
+    uint8_t  i;
+    uint32_t length;
+
+    m_config_loaded = 0;
+    m_config_dirty = 0;
+    for (i = 0; i < OPTIGA_CONFIG_COUNT; i++)
+    {
+        if (readObject(m_config_objects[i][0], m_config_objects[i][1], 0, 1, &m_config_value[i], length)
+            || length != 1)
+        {
+            return IFX_I2C_STACK_ERROR;
+        }
+    }
+    m_config_loaded = 1;
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t OPTIGATrustE::commitConfig(void)
+{
+    uint8_t  i;
+    uint32_t offset;
+
+    for (i = 0; i < OPTIGA_CONFIG_COUNT; i++)
+    {
+        if (m_config_dirty & (1 << i))
+        {
+            offset = 0;
+            // Objects not written yet stay dirty, commitConfig can be called again
+            if (writeObject(m_config_objects[i][0], m_config_objects[i][1], &m_config_value[i], 1, offset))
+            {
+                return IFX_I2C_STACK_ERROR;
+            }
+            m_config_dirty &= ~(1 << i);
+        }
+    }
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+void OPTIGATrustE::releaseConfig(void)
+{
+    m_config_loaded = 0;
+    m_config_dirty = 0;
+}
+
 uint16_t OPTIGATrustE::setCertificate(uint8_t dataToSet[], uint32_t length)
 {
     return generalSetFunction(dataToSet, length, OPTIGA_OID_TAG, OPTIGA_OID_INFINEON_CERT);
@@ -39,12 +39,44 @@
 extern "C"
 {
 #include "util/ifx_i2c/ifx_i2c_transport_layer.h"
+#include "util/ifx_i2c/ifx_i2c_data_link_layer.h"
+#include "util/ifx_i2c/ifx_i2c_physical_layer.h"
+#include "util/WireConnector/WireConnector.h"
 #include <string.h> // memcpy
 #include "util/ifx_i2c/ifx_i2c_hal.h"
+#include "util/ifx_i2c/ifx_i2c_event.h"
+#include "util/ifx_i2c/ifx_i2c_fault.h"
+#include "util/ifx_i2c/ifx_i2c_record.h"
 #include "util/ifx_i2c/ifx_i2c_config.h"
 }
 #include "Wire.h"
 
+/**
+ * @brief Protect the command queues and the claim of the protocol stack against concurrent access.
+ *
+ * The default disables interrupts, which is sufficient for single core Arduino targets. The previous
+ * interrupt state is restored on unlock, so jobs can be submitted from an interrupt handler. On targets
+ * other than AVR, ARM Cortex-M and ESP8266 interrupts are enabled on unlock, submit from tasks only there.
+ * LOCK is used once per function and may declare the local variable UNLOCK needs.
+ * Define both macros for the build of the library to use an RTOS mutex or critical section.
+ */
+#ifndef OPTIGA_QUEUE_LOCK
+#if defined(__AVR__)
+#define OPTIGA_QUEUE_LOCK()             uint8_t optiga_queue_state = SREG; cli()
+#define OPTIGA_QUEUE_UNLOCK()           SREG = optiga_queue_state
+#elif defined(__arm__) && defined(__ARM_ARCH_PROFILE) && (__ARM_ARCH_PROFILE == 'M')
+#define OPTIGA_QUEUE_LOCK()             uint32_t optiga_queue_state; \
+                                        __asm__ volatile ("mrs %0, primask\n\tcpsid i" : "=r" (optiga_queue_state) :: "memory")
+#define OPTIGA_QUEUE_UNLOCK()           __asm__ volatile ("msr primask, %0" :: "r" (optiga_queue_state) : "memory")
+#elif defined(ESP8266)
+#define OPTIGA_QUEUE_LOCK()             uint32_t optiga_queue_state = xt_rsil(15)
+#define OPTIGA_QUEUE_UNLOCK()           xt_wsr_ps(optiga_queue_state)
+#else
+#define OPTIGA_QUEUE_LOCK()             noInterrupts()
+#define OPTIGA_QUEUE_UNLOCK()           interrupts()
+#endif
+#endif
+
 
 
 /**
@@ -55,6 +87,175 @@ extern "C"
  * @brief Module for application-level commands for Infineon OPTIGA Trust E.
  */
 
+/**
+ * @brief Callback receiving a part of a response while it is being read from the device.
+ *
+ * @param[in]  chunk        Pointer to the received bytes, only valid during the call.
+ * @param[in]  offset       Position of the chunk within the complete response data.
+ * @param[in]  length       Number of bytes in the chunk.
+ * @param[in]  context      User context passed to the function starting the read.
+ */
+typedef void (*OPTIGATrustEChunkCallback)(const uint8_t* chunk, uint16_t offset, uint16_t length, void* context);
+
+/**
+ * @brief Callback reporting the end of an initialization started with OPTIGATrustE::beginAsync.
+ *
+ * @param[in]  status       IFX_I2C_STACK_SUCCESS or IFX_I2C_STACK_ERROR.
+ * @param[in]  context      User context passed to OPTIGATrustE::onReady.
+ */
+typedef void (*OPTIGATrustEReadyCallback)(uint16_t status, void* context);
+
+/**
+ * @brief Duration of the steps of the last initialization in microseconds.
+ */
+typedef struct
+{
+    uint32_t soft_reset_us;         /**< Start of the Wire and soft reset of the device */
+    uint32_t negotiation_us;        /**< Frame size written to the device */
+    uint32_t open_application_us;   /**< Open application command after the frame size was written */
+    uint32_t total_us;              /**< From beginAsync (or begin) until the device is ready */
+} OPTIGATrustEBootTiming;
+
+/// Length of a P-256 signature as r and s (32 bytes each, big endian)
+#define OPTIGA_SIGNATURE_RAW_LEN    64
+
+/// Maximum length of a P-256 signature in DER format (sequence of two integers, each up to 33 bytes)
+#define OPTIGA_SIGNATURE_MAX_LEN    72
+
+/// Maximum length of the device certificate (size of its data object)
+#define OPTIGA_CERTIFICATE_MAX_LEN  1728
+
+/// Length of the coprocessor UID
+#define OPTIGA_UID_LEN              27
+
+/// Maximum length of the last error codes (size of their data object)
+#define OPTIGA_ERROR_CODES_MAX_LEN  10
+
+/// Length of an uncompressed P-256 public key (0x04 followed by x and y)
+#define OPTIGA_PUBLIC_KEY_LEN       65
+
+/**
+ * @brief ECDSA P-256 verification supplied by the application (e.g. from micro-ecc or mbed TLS).
+ *
+ * @param[in]  public_key   Public key of the signer, 0x04 followed by x and y.
+ * @param[in]  digest       SHA-256 of the signed data (32 bytes).
+ * @param[in]  signature    r followed by s, each 32 bytes big endian.
+ *
+ * @retval  true   If the signature is valid.
+ */
+typedef bool (*OPTIGATrustEVerifyCallback)(const uint8_t public_key[OPTIGA_PUBLIC_KEY_LEN],
+                                           const uint8_t digest[32],
+                                           const uint8_t signature[OPTIGA_SIGNATURE_RAW_LEN]);
+
+/**
+ * @brief Result of OPTIGATrustE::verifyCertificate, to be kept in non volatile memory.
+ */
+typedef struct
+{
+    uint8_t digest[32];     /**< SHA-256 of the certificate followed by the coprocessor UID */
+    uint8_t valid;          /**< 1 if the certificate was verified, 0 otherwise */
+} OPTIGATrustEVerdict;
+
+/// Range of the current limitation in mA
+#define OPTIGA_CURRENT_LIMIT_MIN    9
+#define OPTIGA_CURRENT_LIMIT_MAX    15
+
+/**
+ * @brief Latency of a command over the rounds of a calibration in microseconds.
+ */
+typedef struct
+{
+    uint32_t min_us;
+    uint32_t avg_us;
+    uint32_t max_us;
+} OPTIGATrustELatency;
+
+/**
+ * @brief Latency profile measured by OPTIGATrustE::calibrateCurrentLimitation.
+ *
+ * Index 0 is OPTIGA_CURRENT_LIMIT_MIN mA, the last index OPTIGA_CURRENT_LIMIT_MAX mA. The profile
+ * can be stored (e.g. in EEPROM) and passed to OPTIGATrustE::applyCurrentLimitation later.
+ */
+typedef struct
+{
+    OPTIGATrustELatency signature[OPTIGA_CURRENT_LIMIT_MAX - OPTIGA_CURRENT_LIMIT_MIN + 1];  /**< getSignature */
+    OPTIGATrustELatency random[OPTIGA_CURRENT_LIMIT_MAX - OPTIGA_CURRENT_LIMIT_MIN + 1];     /**< getRandom of 16 bytes */
+    uint8_t rounds;             /**< Measurements per current limitation, 0 if the profile is not calibrated */
+} OPTIGATrustECurrentProfile;
+
+/**
+ * @brief Counters and timing of OPTIGATrustE::recover.
+ *
+ * Index 0 is the re-synchronization of the link, 1 re-opening the application and 2 the soft reset.
+ */
+typedef struct
+{
+    uint16_t count[3];          /**< Recoveries completed by each tier */
+    uint32_t duration_us[3];    /**< Time spent in each tier during its last attempt */
+    uint16_t failures;          /**< Recoveries where all tiers failed */
+    uint8_t  last_tier;         /**< Tier (1 to 3) that completed the last recovery, 0 if it failed */
+} OPTIGATrustERecoveryStats;
+
+/// Priority classes of queued commands, a lower class is served first
+#define OPTIGA_PRIORITY_HIGH        0
+#define OPTIGA_PRIORITY_NORMAL      1
+#define OPTIGA_PRIORITY_BACKGROUND  2
+#define OPTIGA_PRIORITY_COUNT       3
+
+/**
+ * @brief Callback reporting the end of a command queued with OPTIGATrustE::queueSignature,
+ * OPTIGATrustE::queueReadObject or OPTIGATrustE::queueTransceive.
+ *
+ * @param[in]  status       IFX_I2C_STACK_SUCCESS or IFX_I2C_STACK_ERROR.
+ * @param[in]  length       Number of response bytes written to the buffer of the command.
+ * @param[in]  context      User context passed when the command was queued.
+ */
+typedef void (*OPTIGATrustECommandCallback)(uint16_t status, uint32_t length, void* context);
+
+/**
+ * @brief Latency of the queued commands of a priority class, from queueing until the callback.
+ */
+typedef struct
+{
+    uint32_t target_us;         /**< Latency target set with OPTIGATrustE::setLatencyTarget, 0 if none */
+    uint32_t completed;         /**< Commands completed successfully */
+    uint32_t failed;            /**< Commands that failed */
+    uint32_t missed;            /**< Commands that took longer than target_us */
+    uint32_t max_us;            /**< Longest latency */
+    uint32_t total_us;          /**< Sum of the latencies of all commands (completed and failed) */
+} OPTIGATrustEQueueStats;
+
+/// Number of other devices that can share the I2C bus with the Optiga Trust E
+#ifndef OPTIGA_BUS_DEVICES_MAX
+#define OPTIGA_BUS_DEVICES_MAX      4
+#endif
+/// Device number of the Optiga Trust E itself, see OPTIGATrustE::getBusStats
+#define OPTIGA_BUS_OPTIGA           0xFF
+
+/**
+ * @brief Callback of a device sharing the I2C bus, called while a command waits for the Optiga Trust E.
+ *
+ * The callback may carry out I2C transactions with its device on the Wire of the Optiga Trust E. It must
+ * return within window_us and leave the bus clock as it was (see OPTIGATrustE::getClock).
+ *
+ * @param[in]  window_us    Time until the Optiga Trust E needs the bus again in microseconds.
+ * @param[in]  context      User context passed to OPTIGATrustE::shareBus.
+ *
+ * @retval  true   If the device used the bus, false if it had nothing to do.
+ */
+typedef bool (*OPTIGATrustEBusCallback)(uint32_t window_us, void* context);
+
+/**
+ * @brief Bus occupancy of a device, see OPTIGATrustE::getBusStats.
+ */
+typedef struct
+{
+    uint32_t transactions;      /**< Callbacks that used the bus, commands sent for the Optiga Trust E */
+    uint32_t busy_us;           /**< Time the device used the bus, the occupancy is busy_us / period_us */
+    uint32_t max_wait_us;       /**< Longest time a device waited for the bus during a command, 0 for the Optiga Trust E */
+    uint32_t period_us;         /**< Time since the statistics were reset */
+} OPTIGATrustEBusStats;
+
 class OPTIGATrustE
 {
 public:
@@ -88,6 +289,91 @@ public:
      */
     uint16_t begin(TwoWire& CustomWire);
 
+    /**
+     *
+     * This function initializes the command library like begin(TwoWire&) and optionally
+     * selects the bus clock with probeClock().
+     *
+     * @param[in]  CustomWire       Reference to a custom TwoWire object used with the Optiga.
+     * @param[in]  probe            If true, the fastest reliable bus clock is selected.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS  If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR    If the operation failed.
+     */
+    uint16_t begin(TwoWire& CustomWire, bool probe);
+
+    /**
+     *
+     * This function starts the initialization of begin() and returns without waiting for the device.
+     * The initialization is advanced by isReady(), which should be called from loop(). Any other command
+     * waits for the initialization to finish.
+     * A queued signature waiting between its commands starts again with the scheme, a queued command
+     * whose response has not been processed by poll() yet fails.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS  If the initialization was started.
+     * @retval  IFX_I2C_STACK_ERROR    If a command or an initialization is in progress.
+     */
+    uint16_t beginAsync(void);
+
+    /**
+     *
+     * This function starts the initialization of begin(TwoWire&) and returns without waiting for the device.
+     *
+     * @param[in]  CustomWire       Reference to a custom TwoWire object used with the Optiga.
+     * @param[in]  timeout_ms       The initialization fails if the device is not ready within this time, 0 for no limit.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS  If the initialization was started.
+     * @retval  IFX_I2C_STACK_ERROR    If a command or an initialization is in progress.
+     */
+    uint16_t beginAsync(TwoWire& CustomWire, uint32_t timeout_ms);
+
+    /**
+     *
+     * This function advances an initialization started with beginAsync by one step.
+     *
+     * @retval  true   If the device is initialized.
+     * @retval  false  If the initialization is still running or has failed.
+     */
+    bool isReady(void);
+
+    /**
+     *
+     * This function registers a callback, which is called once the initialization is finished.
+     * If it has already finished, the callback is called right away.
+     *
+     * @param[in]  callback         Function to call, NULL to remove the callback.
+     * @param[in]  context          User context passed to the callback.
+     */
+    void onReady(OPTIGATrustEReadyCallback callback, void* context);
+
+    /**
+     *
+     * This function returns the duration of the steps of the last initialization.
+     *
+     * @param[out]  timing      Duration of soft reset, frame size negotiation and open application.
+     */
+    void getBootTiming(OPTIGATrustEBootTiming& timing);
+
+    /**
+     *
+     * This function selects the fastest bus clock (1 MHz, 400 kHz, 100 kHz) at which a few reads of the
+     * coprocessor UID complete without any CRC error, NACK or failed transfer on the data link layer.
+     * Afterwards the data link errors are monitored, and the clock is lowered by one step if too many
+     * errors occur within a number of transactions. The selected clock is kept by reset().
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS  If a clock was selected.
+     * @retval  IFX_I2C_STACK_ERROR    If the device did not respond reliably at any clock.
+     */
+    uint16_t probeClock(void);
+
+    /**
+     *
+     * This function returns the bus clock selected by probeClock().
+     *
+     * @retval  Clock in Hz, 0 if the clock is not managed by the library.
+     */
+    uint32_t getClock(void);
+
     /**
      *
      * This function resets the Infineon OPTIGA Trust E. This helps to recover the connection 
@@ -97,6 +383,28 @@ public:
      * @retval  IFX_I2C_STACK_ERROR    If the operation failed.
      */
 	uint16_t reset(void);
+
+    /**
+     *
+     * This function recovers the connection after a failed command with the cheapest step that works:
+     * 1. the frame counters are re-synchronized and the session is checked with a read of the coprocessor UID,
+     * 2. the application is opened again (and the auth scheme selected again if setAuthScheme was used),
+     * 3. the device is reset like reset() (and the auth scheme selected again).
+     * Each tier is counted and timed, see getRecoveryStats().
+     * A queued signature waiting between its commands starts again with the scheme in tiers 2 and 3.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS  If one of the tiers was successful.
+     * @retval  IFX_I2C_STACK_ERROR    If the connection could not be recovered.
+     */
+    uint16_t recover(void);
+
+    /**
+     *
+     * This function returns the counters and timing of recover().
+     *
+     * @param[out]  stats       Statistics since start up.
+     */
+    void getRecoveryStats(OPTIGATrustERecoveryStats& stats);
 	
     /**
      *
@@ -131,6 +439,8 @@ public:
      * In addition, the receiver of the certificate can verify the chain of trust
      * by validating the issuer of the certificate and the issuer's signature on it.
      *
+     * pp_cert has to hold OPTIGA_CERTIFICATE_MAX_LEN bytes, pass the size of a smaller buffer with the overload below.
+     *
      * @param[out] pp_cert      Pointer to the buffer that will contain the output.
      * @param[out] p_length     Pointer to the variable that will contain the length.
      *
@@ -139,6 +449,40 @@ public:
      */
     uint16_t getCertificate(uint8_t pp_cert[], uint32_t& p_length);
 
+    /**
+     * @brief Get the device certificate like getCertificate, the certificate is written up to cert_size bytes.
+     *
+     * @param[out] pp_cert      Pointer to the buffer that will contain the output.
+     * @param[in]  cert_size    Size of pp_cert (OPTIGA_CERTIFICATE_MAX_LEN bytes hold every certificate).
+     * @param[out] p_length     Pointer to the variable that will contain the length.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If the operation failed or the certificate does not fit into pp_cert.
+     */
+    uint16_t getCertificate(uint8_t pp_cert[], uint16_t cert_size, uint32_t& p_length);
+
+    /**
+     * @brief Get the Infineon OPTIGA Trust E device certificate in chunks.
+     *
+     * The function retrieves the public X.509 certificate like @ref getCertificate, but instead
+     * of copying it to a buffer, the certificate is passed to the callback in consecutive chunks.
+     * With IFX_I2C_TL_STREAMING set in ifx_i2c_config.h the chunks are delivered while the
+     * remaining transport fragments are still being read, so a hash can be computed or the
+     * certificate can be forwarded without buffering it.
+     * Otherwise the certificate is delivered once the complete response has been received.
+     *
+     * @attention The chunks are delivered before the response has been checked. Discard
+     *            the result if the function does not return IFX_I2C_STACK_SUCCESS.
+     *
+     * @param[in]  callback     Function receiving the chunks of the certificate.
+     * @param[in]  context      User context passed to the callback.
+     * @param[out] p_length     Pointer to the variable that will contain the length.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If the operation failed.
+     */
+    uint16_t getCertificate(OPTIGATrustEChunkCallback callback, void* context, uint32_t& p_length);
+
     /**
      * @brief Set the authentication scheme.
      *
@@ -146,7 +490,9 @@ public:
      * Currently only the ECDSA with the elliptic curve SECP256R1 and
      * hash algorithm SHA256 is supported.
      *
-     * @attention This function must be called once before calling @ref optiga_sign
+     * The scheme stays selected for the application session, further calls return without a command.
+     * getSignature selects it itself if needed, it is selected again after begin, reset and recover.
+     * A failed signature or an 'open application' sent with transceive ends it, it is selected again by the next call.
      *
      * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
      * @retval  IFX_I2C_STACK_ERROR If the operation failed.
@@ -165,7 +511,7 @@ public:
      *
      * @param[in]  p_message        Pointer to the buffer containing the message to be signed.
      * @param[in]  message_length   Length of the message.
-     * @param[out] pp_signature     Pointer to the buffer that will contain the signature.
+     * @param[out] pp_signature     Pointer to the buffer that will contain the signature (OPTIGA_SIGNATURE_MAX_LEN bytes).
      *
      * @param[out] p_signature_len  Pointer to the variable which will contain the signature length.
      *
@@ -175,6 +521,69 @@ public:
     uint16_t getSignature(uint8_t p_message[], uint16_t message_length,
                           uint8_t pp_signature[], uint32_t& p_signature_len);
 
+    /**
+     * @brief Sign a message like getSignature, the signature is written up to signature_size bytes.
+     *
+     * @param[in]  p_message        Pointer to the buffer containing the message to be signed (16 bytes).
+     * @param[in]  message_length   Length of the message.
+     * @param[out] pp_signature     Pointer to the buffer that will contain the signature.
+     * @param[in]  signature_size   Size of pp_signature (OPTIGA_SIGNATURE_MAX_LEN bytes hold every signature).
+     * @param[out] p_signature_len  Pointer to the variable which will contain the signature length.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If the operation failed or the signature does not fit into pp_signature.
+     */
+    uint16_t getSignature(uint8_t p_message[], uint16_t message_length,
+                          uint8_t pp_signature[], uint16_t signature_size, uint32_t& p_signature_len);
+
+    /**
+     * @brief Sign a message like getSignature and return the signature as r and s.
+     *
+     * @param[in]  p_message        Pointer to the buffer containing the message to be signed (16 bytes).
+     * @param[in]  message_length   Length of the message.
+     * @param[out] signature        r followed by s, each 32 bytes big endian.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If the operation failed or the signature is not a P-256 signature.
+     */
+    uint16_t getSignatureRaw(uint8_t p_message[], uint16_t message_length,
+                             uint8_t signature[OPTIGA_SIGNATURE_RAW_LEN]);
+
+    /**
+     * @brief Convert a signature returned by getSignature from DER to r and s.
+     *
+     * The function does not access the device, so it can be used wherever signatures are verified,
+     * most ECDSA verifiers take r and s instead of DER.
+     *
+     * @param[in]  der              Signature in DER format, SEQUENCE { INTEGER r, INTEGER s }.
+     * @param[in]  der_length       Length of the DER signature.
+     * @param[out] signature        r followed by s, each 32 bytes big endian.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If the encoding is invalid or a number is larger than 32 bytes.
+     */
+    static uint16_t decodeSignature(const uint8_t der[], uint32_t der_length,
+                                    uint8_t signature[OPTIGA_SIGNATURE_RAW_LEN]);
+
+    /**
+     * @brief Verify the device certificate against the Infineon OPTIGA(TM) Trust E CA 001 (see misc/).
+     *
+     * The certificate is read like getCertificate. If the verdict was produced before for the same
+     * certificate and coprocessor UID, the function returns without verifying the signature again.
+     * Otherwise the signature of the certificate is checked with the CA public key and the verdict is
+     * updated. Store the verdict between boots to skip the ECDSA verification.
+     *
+     * @param[out]    certificate   Buffer receiving the certificate (OPTIGA_CERTIFICATE_MAX_LEN bytes).
+     * @param[out]    length        Length of the certificate.
+     * @param[in]     verify        ECDSA P-256 verification, only called if the verdict does not match.
+     * @param[in,out] verdict       Verdict of an earlier call (valid = 0 if there is none).
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If the certificate is issued by the CA.
+     * @retval  IFX_I2C_STACK_ERROR If the verification or the operation failed.
+     */
+    uint16_t verifyCertificate(uint8_t certificate[], uint32_t& length,
+                               OPTIGATrustEVerifyCallback verify, OPTIGATrustEVerdict& verdict);
+
 
     /**
      * This function returns the Global Life cycle status. Default value 0x07.
@@ -189,7 +598,7 @@ public:
      * The life cycle status allows the device to identify the different logical security states of the use of the device,
      * application and other objects in the device.
      *
-     * responseBuffer[out]      Pointer where the value will be stored
+     * responseBuffer[out]      Pointer where the value will be stored (1 byte)
      * responseLength[out]      Pointer where the length of the value is stored
      *
      * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
@@ -202,7 +611,7 @@ public:
      * First 25 bytes is the unique hardware identifier
      * Last 2 bytes is the Embedded Software Build Number BCD Coded
      *
-     * responseBuffer[out]      Pointer where the value will be stored
+     * responseBuffer[out]      Pointer where the value will be stored (OPTIGA_UID_LEN bytes)
      * responseLength[out]      Pointer where the length of the value is stored
      *
      * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
@@ -211,9 +620,21 @@ public:
     uint16_t getCoprocessorId(uint8_t responseBuffer[], uint32_t& responseLength);
 
     /**
-     * This function returns the Global Security status. Default value 0x00
+     * This function returns the Coprocessor UID value like getCoprocessorId, the value is written up to responseSize bytes.
      *
      * responseBuffer[out]      Pointer where the value will be stored
+     * responseSize[in]         Size of responseBuffer
+     * responseLength[out]      Pointer where the length of the value is stored
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If the operation failed or the value does not fit into responseBuffer.
+     */
+    uint16_t getCoprocessorId(uint8_t responseBuffer[], uint16_t responseSize, uint32_t& responseLength);
+
+    /**
+     * This function returns the Global Security status. Default value 0x00
+     *
+     * responseBuffer[out]      Pointer where the value will be stored (1 byte)
      * responseLength[out]      Pointer where the length of the value is stored
      * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
      *
@@ -227,7 +648,7 @@ public:
      *
      *  Default value 0x14.
      *
-     * responseBuffer[out]      Pointer where the value will be stored
+     * responseBuffer[out]      Pointer where the value will be stored (1 byte)
      * responseLength[out]      Pointer where the length of the value is stored
      *
      * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
@@ -241,7 +662,7 @@ public:
      *
      *  Default value 0x09
      *
-     * responseBuffer[out]      Pointer where the value will be stored
+     * responseBuffer[out]      Pointer where the value will be stored (1 byte)
      * responseLength[out]      Pointer where the length of the value is stored
      *
      *
@@ -253,7 +674,7 @@ public:
     /**
      * This function returns the security event counter. Default value 0x09
      *
-     * responseBuffer[out]      Pointer where the value will be stored
+     * responseBuffer[out]      Pointer where the value will be stored (1 byte)
      * responseLength[out]      Pointer where the length of the value is stored
      *
      * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
@@ -274,7 +695,7 @@ public:
      * The life cycle status allows the device to identify the different logical security states of the use of the device,
      * application and other objects in the device.
      *
-     * responseBuffer[out]      Pointer where the value will be stored
+     * responseBuffer[out]      Pointer where the value will be stored (1 byte)
      * responseLength[out]      Pointer where the length of the value is stored
      *
      * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
@@ -294,7 +715,7 @@ public:
      * The life cycle status allows the device to identify the different logical security states of the use of the device,
      * application and other objects in the device.
      *
-     * responseBuffer[out]      Pointer where the value will be stored
+     * responseBuffer[out]      Pointer where the value will be stored (1 byte)
      * responseLength[out]      Pointer where the length of the value is stored
      *
      * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
@@ -305,7 +726,7 @@ public:
     /**
      * This function returns the last error code.
      *
-     * responseBuffer[out]      Pointer where the value will be stored
+     * responseBuffer[out]      Pointer where the value will be stored (OPTIGA_ERROR_CODES_MAX_LEN bytes)
      * responseLength[out]      Pointer where the length of the value is stored
      *
      * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
@@ -313,6 +734,36 @@ public:
      */
     uint16_t getLastErrorCodes(uint8_t responseBuffer[], uint32_t& responseLength);
 
+    /**
+     * This function returns the last error codes like getLastErrorCodes, the value is written up to responseSize bytes.
+     *
+     * responseBuffer[out]      Pointer where the value will be stored
+     * responseSize[in]         Size of responseBuffer
+     * responseLength[out]      Pointer where the length of the value is stored
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If the operation failed or the value does not fit into responseBuffer.
+     */
+    uint16_t getLastErrorCodes(uint8_t responseBuffer[], uint16_t responseSize, uint32_t& responseLength);
+
+    /**
+     * This function reads a part of a data object, starting at offset and returning at most length bytes.
+     * Use it to read a single field or the header of a large object (e.g. the first 4 bytes of a certificate
+     * hold its ASN.1 length) without transferring the whole object.
+     *
+     * tag[in]                  Tag of the data object (e.g. 0xE0)
+     * OID[in]                  Object identifier of the data object (e.g. 0xE0)
+     * offset[in]               Position of the first byte to read within the object
+     * length[in]               Maximum number of bytes to read, responseBuffer must hold this many bytes
+     * responseBuffer[out]      Pointer where the value will be stored
+     * responseLength[out]      Pointer where the number of bytes read is stored, less than length if the object ends before
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If the operation failed.
+     */
+    uint16_t readObject(uint8_t tag, uint8_t OID, uint16_t offset, uint16_t length,
+                        uint8_t responseBuffer[], uint32_t& responseLength);
+
     /**
      * This function sets the Global Life Cycle Status.
      *
@@ -364,6 +815,31 @@ public:
      */
     uint16_t setCurrentLimitation(uint8_t dataToWrite[]);
 
+    /**
+     * This function measures getRandom and getSignature at each current limitation from OPTIGA_CURRENT_LIMIT_MIN
+     * to OPTIGA_CURRENT_LIMIT_MAX mA. The auth scheme is selected before the measurement.
+     * The current limitation of the device is restored afterwards.
+     *
+     * profile[out]         Latency measured at each current limitation
+     * rounds[in]           Number of measurements per current limitation (1 - 255)
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If the operation failed.
+     */
+    uint16_t calibrateCurrentLimitation(OPTIGATrustECurrentProfile& profile, uint8_t rounds);
+
+    /**
+     * This function sets the lowest current limitation at which the slowest signature of the profile
+     * did not exceed the given latency.
+     *
+     * profile[in]          Profile measured with calibrateCurrentLimitation
+     * max_signature_us[in] Latency target of getSignature in microseconds
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If no current limitation meets the target or the operation failed.
+     */
+    uint16_t applyCurrentLimitation(const OPTIGATrustECurrentProfile& profile, uint32_t max_signature_us);
+
     /**
      * This function sets the Application Life Cycle Status.
      *
@@ -394,6 +870,31 @@ public:
      */
     uint16_t setAppSecurityStatus(uint8_t dataToWrite[]);
 
+    /**
+     * This function reads the sleep mode activation delay, current limitation, Lcsa and Lcsg into a shadow in RAM.
+     * Until releaseConfig is called, the getters of these objects return the shadow and the setters only change
+     * the shadow. The security status objects are not shadowed, the device updates them itself.
+     * begin, reset and recover drop the shadow and changes not committed yet.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If the operation failed, the shadow is not used.
+     */
+    uint16_t loadConfig(void);
+
+    /**
+     * This function writes the objects of the shadow that were changed since loadConfig or the last commitConfig.
+     * The life cycle states are written last, they only move forward and can restrict writing the other objects.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If the operation failed, objects not written remain changed.
+     */
+    uint16_t commitConfig(void);
+
+    /**
+     * This function drops the shadow without writing it, the getters and setters access the device again.
+     */
+    void releaseConfig(void);
+
     /**
      * Sets the device public key. There are restrictions built into the Optiga Chip about when you can change the certificate, so will not succeed everytime.
      *
@@ -403,6 +904,163 @@ public:
      */
     uint16_t setCertificate(uint8_t dataToWrite[], uint32_t length);
 
+    /**
+     * Writes data to a data object in chunks, using increasing write offsets. Each chunk fills a few
+     * transport layer fragments, so the memory needed does not depend on the length of the data.
+     *
+     * offset is advanced after every chunk acknowledged by the device. If the function fails, it holds
+     * the position of the first byte not written, and calling the function again with the same arguments
+     * resumes the write from there.
+     *
+     * tag[in]              Tag of the data object (e.g. 0xE0)
+     * OID[in]              Object identifier of the data object (e.g. 0xE1)
+     * dataToWrite[in]      Pointer to the complete data of the object
+     * length[in]           Length of dataToWrite
+     * offset[in,out]       Position within dataToWrite and the object to start writing at (0 for a new write)
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If the operation failed.
+     */
+    uint16_t writeObject(uint8_t tag, uint8_t OID, uint8_t dataToWrite[], uint32_t length, uint32_t& offset);
+
+    /**
+     * @brief Send a raw command APDU and retrieve the response data.
+     *
+     * The APDU must already contain the 4 byte command header (command, param, length).
+     * On success the response data without the response header is copied to response.
+     *
+     * apdu[in]                 Pointer to the complete command APDU
+     * length[in]               Length of the command APDU
+     * response[out]            Pointer where the response data will be stored, may be NULL
+     * responseSize[in]         Size of response, at most responseSize bytes are written
+     * responseLength[out]      Pointer where the length of the response data is stored
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If the operation failed, another command is in progress or the response
+     *                              does not fit into response.
+     */
+    uint16_t transceive(uint8_t apdu[], uint16_t length, uint8_t response[], uint16_t responseSize,
+                        uint32_t& responseLength);
+
+    /**
+     * @brief Queue a signature of a 16 byte message, see getSignature.
+     *
+     * Queued commands are carried out by poll(), the highest priority class first and in the order they were
+     * queued within a class. The commands of a signature are sent back to back, the auth scheme is selected
+     * first if it is not selected in this application session. Commands can be queued from any task or an
+     * interrupt handler, the queue is protected by OPTIGA_QUEUE_LOCK like OPTIGATrustEQueue.
+     *
+     * priority[in]             OPTIGA_PRIORITY_HIGH, OPTIGA_PRIORITY_NORMAL or OPTIGA_PRIORITY_BACKGROUND
+     * p_message[in]            Message to sign, it is copied
+     * message_length[in]       Length of the message (16)
+     * pp_signature[out]        Pointer where the signature in DER format will be stored, valid until the callback
+     * signature_size[in]       Size of pp_signature (72 bytes hold every signature)
+     * callback[in]             Function called with the result and the signature length, may be NULL
+     * context[in]              User context passed to callback
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If the command was queued.
+     * @retval  IFX_I2C_STACK_ERROR If the parameters are invalid or the queue is full.
+     */
+    uint16_t queueSignature(uint8_t priority, uint8_t p_message[], uint16_t message_length,
+                            uint8_t pp_signature[], uint16_t signature_size,
+                            OPTIGATrustECommandCallback callback, void* context);
+
+    /**
+     * @brief Queue a read of a data object, see readObject.
+     *
+     * The object is read with one command per OPTIGA_QUEUE_READ_CHUNK bytes (128 by default). Between two chunks poll() serves
+     * commands of a higher priority class first, so a long read does not delay them. The read ends early
+     * if the object ends, callback receives the number of bytes read.
+     *
+     * priority[in]             OPTIGA_PRIORITY_HIGH, OPTIGA_PRIORITY_NORMAL or OPTIGA_PRIORITY_BACKGROUND
+     * tag[in]                  Tag of the data object (e.g. 0xE0)
+     * OID[in]                  Object identifier of the data object (e.g. 0xE0 for the certificate)
+     * offset[in]               Position within the object to start reading at
+     * length[in]               Number of bytes to read
+     * responseBuffer[out]      Pointer where the data will be stored, valid until the callback
+     * callback[in]             Function called with the result and the number of bytes read, may be NULL
+     * context[in]              User context passed to callback
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If the command was queued.
+     * @retval  IFX_I2C_STACK_ERROR If the parameters are invalid or the queue is full.
+     */
+    uint16_t queueReadObject(uint8_t priority, uint8_t tag, uint8_t OID, uint16_t offset, uint16_t length,
+                             uint8_t responseBuffer[], OPTIGATrustECommandCallback callback, void* context);
+
+    /**
+     * @brief Queue a raw command APDU, see transceive.
+     *
+     * priority[in]             OPTIGA_PRIORITY_HIGH, OPTIGA_PRIORITY_NORMAL or OPTIGA_PRIORITY_BACKGROUND
+     * apdu[in]                 Pointer to the complete command APDU, valid until the callback
+     * length[in]               Length of the command APDU
+     * response[out]            Pointer where the response data will be stored, may be NULL
+     * responseSize[in]         Size of response
+     * callback[in]             Function called with the result and the response length, may be NULL
+     * context[in]              User context passed to callback
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If the command was queued.
+     * @retval  IFX_I2C_STACK_ERROR If the parameters are invalid or the queue is full.
+     */
+    uint16_t queueTransceive(uint8_t priority, const uint8_t apdu[], uint16_t length,
+                             uint8_t response[], uint16_t responseSize,
+                             OPTIGATrustECommandCallback callback, void* context);
+
+    /**
+     * @brief Advance the queued commands without waiting for the device.
+     *
+     * Has to be called repeatedly (e.g. from loop()), the callbacks of the commands are called from here.
+     * Blocking functions called meanwhile wait for the command being sent and run before the next
+     * queued command, so they take precedence over all priority classes. A call from another context while
+     * poll() runs returns true without serving the queue.
+     *
+     * @retval  true  While commands are queued or running.
+     */
+    bool poll(void);
+
+    /**
+     * @brief Set the latency target of a priority class, commands exceeding it are counted as missed.
+     *
+     * priority[in]             Priority class
+     * target_us[in]            Longest latency from queueing until the callback in microseconds, 0 for none
+     */
+    void setLatencyTarget(uint8_t priority, uint32_t target_us);
+
+    /**
+     * @brief Get the latency statistics of a priority class.
+     *
+     * priority[in]             Priority class
+     * stats[out]               Statistics since the last reset
+     * reset[in]                If true, the counters are cleared after reading (the target is kept)
+     */
+    void getQueueStats(uint8_t priority, OPTIGATrustEQueueStats& stats, bool reset);
+
+    /**
+     * @brief Let another device use the I2C bus while a command waits for the Optiga Trust E.
+     *
+     * During a command the bus is only needed for the transfers of the frames and the polls of the device
+     * state, between them the stack waits (e.g. PL_POLLING_INVERVAL_US while the device computes a signature).
+     * In these windows the callbacks of the devices are called in turn, a device only if the remaining window
+     * is at least duration_us.
+     *
+     * callback[in]             Function carrying out the transactions of the device
+     * context[in]              User context passed to callback
+     * duration_us[in]          Longest time the callback uses the bus in microseconds
+     * device[out]              Number of the device for getBusStats
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If the device was added.
+     * @retval  IFX_I2C_STACK_ERROR If callback is NULL or OPTIGA_BUS_DEVICES_MAX devices share the bus already.
+     */
+    uint16_t shareBus(OPTIGATrustEBusCallback callback, void* context, uint32_t duration_us, uint8_t& device);
+
+    /**
+     * @brief Get the bus occupancy of a device sharing the bus or of the Optiga Trust E.
+     *
+     * device[in]               Number returned by shareBus or OPTIGA_BUS_OPTIGA
+     * stats[out]               Statistics since the last reset
+     * reset[in]                If true, the statistics are cleared after reading
+     */
+    void getBusStats(uint8_t device, OPTIGATrustEBusStats& stats, bool reset);
+
 private:
 	/**
 	 * This function creates the header of length 4, which includes the command, param and the length of the data
@@ -412,12 +1070,59 @@ private:
 	/**
 	 * This function sends the apdu to the transport layer, which deals with the communication with the Optiga Trust E.
 	 * At the end of the operation, the handler is called.
+	 * The response data (without header) is copied to response, at most response_size bytes.
+	 */
+	uint16_t SendApdu(const uint8_t* data, uint16_t length, uint8_t* response, uint16_t response_size);
+
+	/**
+	 * This function sends the message to the device and reads the signature in DER format
+	 */
+	uint16_t SignMessage(uint8_t p_message[], uint16_t message_length, uint8_t* signature, uint16_t signature_size);
+
+	/**
+	 * This function hands the apdu to the transport layer and returns, see SendApdu
+	 */
+	uint16_t StartApdu(const uint8_t* data, uint16_t length, uint8_t* response, uint16_t response_size);
+
+	/**
+	 * This function checks the response of the completed transaction
+	 */
+	uint16_t FinishApdu(void);
+
+	/**
+	 * This function advances an initialization started with beginAsync by one step
+	 */
+	void BootPoll(void);
+
+	/**
+	 * This function starts the next command of the queued command selected by poll
+	 */
+	void QueueStart(void);
+
+	/**
+	 * This function processes the response of a queued command and reports or re-queues the command
+	 */
+	void QueueComplete(uint16_t status);
+
+	/**
+	 * This function restarts or aborts the current queued command when a new application session starts
+	 */
+	void QueueRestart(void);
+
+	/**
+	 * This function re-synchronizes the transport and data link layer with the device and waits for completion
+	 */
+	uint16_t ResyncLink(void);
+
+	/**
+	 * This function determines the length of the certificate received with the last response
 	 */
-	uint16_t SendApdu(uint8_t* data, uint16_t length);
+	uint16_t CertificateLength(uint32_t& p_length);
     /**
-     * This function is a generalized version of the function used to get the values stored in the various data structures, where permitted
+     * This function is a generalized version of the function used to get the values stored in the various data structures, where permitted.
+     * At most responseSize bytes are written to responseBuffer.
      */
-    uint16_t generalGetFunction(uint8_t* responseBuffer, uint32_t& responseLength, uint8_t tag, uint8_t OID);
+    uint16_t generalGetFunction(uint8_t* responseBuffer, uint16_t responseSize, uint32_t& responseLength, uint8_t tag, uint8_t OID);
 
     /**
      * This function is a generalized version of the function used to set the values stored in the various data structures, where permitted
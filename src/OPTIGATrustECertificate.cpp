@@ -0,0 +1,266 @@
+/*
+* Copyright (c) 2017, Infineon Technologies AG
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1.  Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*
+* 2.  Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+* 3.  Neither the name of the copyright holder nor the names of its contributors
+*     may be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include "OPTIGATrustECertificate.h"
+
+// ASN.1 tags used by certificates
+#define ASN1_INTEGER                            0x02
+#define ASN1_BIT_STRING                         0x03
+#define ASN1_SEQUENCE                           0x30
+#define ASN1_CONTEXT_0                          0xA0
+// Accept any tag (notBefore and notAfter are UTCTime or GeneralizedTime)
+#define ASN1_ANY                                0x00
+
+OPTIGATrustECertificate::OPTIGATrustECertificate(const uint8_t* certificate, uint32_t length) :
+    m_certificate(certificate), m_length(0), m_located(0), m_position(0), m_invalid(0)
+{
+    // Certificates of the device are far below 64 kB, the offsets are 16 bit
+    if (certificate == NULL || length > 0xFFFF)
+    {
+        m_invalid = 1;
+        return;
+    }
+    m_length = length;
+}
+
+/**
+ * This function decodes tag and length of the element at position, which must end before end.
+ * Returns the offset and length of its content.
+ */
+static uint16_t optiga_asn1_decode(const uint8_t* data, uint16_t position, uint16_t end, uint8_t tag,
+                                   uint16_t& content, uint16_t& length)
+{
+    uint16_t header = 2;
+
+    if (end < 2 || position > end - 2 || (tag != ASN1_ANY && data[position] != tag))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    // Short form or long form with one or two length bytes
+    length = data[position + 1];
+    if (length == 0x81 || length == 0x82)
+    {
+        header += length - 0x80;
+        if (position > end - header)
+        {
+            return IFX_I2C_STACK_ERROR;
+        }
+        length = (length == 0x81) ? data[position + 2] : (data[position + 2] << 8) | data[position + 3];
+    }
+    else if (length >= 0x80)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    if (length > end - position - header)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    content = position + header;
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+/**
+ * This function decodes the fields up to the requested one, fields located before are not decoded again
+ */
+uint16_t OPTIGATrustECertificate::locate(uint8_t field)
+{
+    uint16_t content;
+    uint16_t length;
+    uint16_t end;
+    uint8_t  tag;
+
+    if (field >= OPTIGA_CERT_FIELD_COUNT || m_invalid)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    while (m_located <= field)
+    {
+        if (m_located == OPTIGA_CERT_TBS)
+        {
+            // Certificate ::= SEQUENCE { tbsCertificate, signatureAlgorithm, signatureValue }, the buffer may be longer
+            if (optiga_asn1_decode(m_certificate, 0, m_length, ASN1_SEQUENCE, content, length))
+            {
+                m_invalid = 1;
+                return IFX_I2C_STACK_ERROR;
+            }
+            m_length = content + length;
+            m_position = content;
+        }
+
+        switch (m_located)
+        {
+            case OPTIGA_CERT_SERIAL_NUMBER:     tag = ASN1_INTEGER;     break;
+            case OPTIGA_CERT_SIGNATURE_VALUE:   tag = ASN1_BIT_STRING;  break;
+            default:                            tag = ASN1_SEQUENCE;    break;
+        }
+
+        // The TBSCertificate fields end with it, extensions at its end are skipped
+        end = m_length;
+        if (m_located > OPTIGA_CERT_TBS && m_located < OPTIGA_CERT_SIGNATURE_ALGORITHM)
+        {
+            end = m_content[OPTIGA_CERT_TBS] + m_contentLength[OPTIGA_CERT_TBS];
+        }
+        else if (m_located == OPTIGA_CERT_SIGNATURE_ALGORITHM)
+        {
+            m_position = m_content[OPTIGA_CERT_TBS] + m_contentLength[OPTIGA_CERT_TBS];
+        }
+
+        if (optiga_asn1_decode(m_certificate, m_position, end, tag, content, length))
+        {
+            m_invalid = 1;
+            return IFX_I2C_STACK_ERROR;
+        }
+        m_element[m_located] = m_position;
+        m_content[m_located] = content;
+        m_contentLength[m_located] = length;
+        m_position = content + length;
+
+        // Continue inside the TBSCertificate, after the optional version
+        if (m_located == OPTIGA_CERT_TBS)
+        {
+            m_position = content;
+            if (!optiga_asn1_decode(m_certificate, content, content + length, ASN1_CONTEXT_0, content, length))
+            {
+                m_position = content + length;
+            }
+        }
+        m_located++;
+    }
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t OPTIGATrustECertificate::getElement(uint8_t field, const uint8_t*& element, uint16_t& length)
+{
+    if (locate(field))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    element = m_certificate + m_element[field];
+    length = m_content[field] - m_element[field] + m_contentLength[field];
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t OPTIGATrustECertificate::getContent(uint8_t field, const uint8_t*& content, uint16_t& length)
+{
+    if (locate(field))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    content = m_certificate + m_content[field];
+    length = m_contentLength[field];
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t OPTIGATrustECertificate::getSerialNumber(const uint8_t*& serial, uint16_t& length)
+{
+    return getContent(OPTIGA_CERT_SERIAL_NUMBER, serial, length);
+}
+
+uint16_t OPTIGATrustECertificate::getValidity(const uint8_t*& notBefore, uint8_t& notBeforeLength,
+                                              const uint8_t*& notAfter, uint8_t& notAfterLength)
+{
+    uint16_t content;
+    uint16_t length;
+    uint16_t end;
+
+    if (locate(OPTIGA_CERT_VALIDITY))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    // Validity ::= SEQUENCE { notBefore Time, notAfter Time }
+    end = m_content[OPTIGA_CERT_VALIDITY] + m_contentLength[OPTIGA_CERT_VALIDITY];
+    if (optiga_asn1_decode(m_certificate, m_content[OPTIGA_CERT_VALIDITY], end, ASN1_ANY, content, length))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    notBefore = m_certificate + content;
+    notBeforeLength = length;
+
+    if (optiga_asn1_decode(m_certificate, content + length, end, ASN1_ANY, content, length))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    notAfter = m_certificate + content;
+    notAfterLength = length;
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+/**
+ * This function returns the content of the BIT STRING at position without the number of unused bits
+ */
+uint16_t OPTIGATrustECertificate::getBitString(uint16_t position, uint16_t end, const uint8_t*& bits, uint16_t& length)
+{
+    uint16_t content;
+
+    // Keys and signatures are whole bytes
+    if (optiga_asn1_decode(m_certificate, position, end, ASN1_BIT_STRING, content, length)
+        || length < 1 || m_certificate[content] != 0)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    bits = m_certificate + content + 1;
+    length--;
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t OPTIGATrustECertificate::getPublicKey(const uint8_t*& key, uint16_t& length)
+{
+    uint16_t content;
+    uint16_t end;
+
+    if (locate(OPTIGA_CERT_PUBLIC_KEY_INFO))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    // SubjectPublicKeyInfo ::= SEQUENCE { algorithm AlgorithmIdentifier, subjectPublicKey BIT STRING }
+    end = m_content[OPTIGA_CERT_PUBLIC_KEY_INFO] + m_contentLength[OPTIGA_CERT_PUBLIC_KEY_INFO];
+    if (optiga_asn1_decode(m_certificate, m_content[OPTIGA_CERT_PUBLIC_KEY_INFO], end, ASN1_SEQUENCE, content, length))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    return getBitString(content + length, end, key, length);
+}
+
+uint16_t OPTIGATrustECertificate::getSignature(const uint8_t*& signature, uint16_t& length)
+{
+    if (locate(OPTIGA_CERT_SIGNATURE_VALUE))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    return getBitString(m_element[OPTIGA_CERT_SIGNATURE_VALUE], m_length, signature, length);
+}
@@ -0,0 +1,134 @@
+/*
+* Copyright (c) 2017, Infineon Technologies AG
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1.  Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*
+* 2.  Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+* 3.  Neither the name of the copyright holder nor the names of its contributors
+*     may be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#ifndef OPTIGATRUSTECERTIFICATE_H_
+#define OPTIGATRUSTECERTIFICATE_H_
+
+#include "OPTIGATrustE.h"
+
+/**
+ * @defgroup ifx_optiga_certificate Infineon OPTIGA Trust E Certificate View
+ * @{
+ * @ingroup ifx_optiga
+ *
+ * @brief Read only view of an X.509 certificate in DER format, e.g. as returned by getCertificate.
+ *
+ * The view does not copy or allocate. Fields are located on first access and their offsets are
+ * remembered, so later accesses (e.g. the public key for each handshake) are a table lookup.
+ * Returned pointers point into the buffer of the certificate, which must stay valid and unchanged.
+ */
+
+/** @brief Fields of the certificate, in the order of their encoding */
+#define OPTIGA_CERT_TBS                 0   /**< TBSCertificate, the signed part */
+#define OPTIGA_CERT_SERIAL_NUMBER       1   /**< serialNumber (INTEGER) */
+#define OPTIGA_CERT_TBS_SIGNATURE       2   /**< signature algorithm inside the TBSCertificate */
+#define OPTIGA_CERT_ISSUER              3   /**< issuer (Name) */
+#define OPTIGA_CERT_VALIDITY            4   /**< validity (SEQUENCE of notBefore and notAfter) */
+#define OPTIGA_CERT_SUBJECT             5   /**< subject (Name) */
+#define OPTIGA_CERT_PUBLIC_KEY_INFO     6   /**< subjectPublicKeyInfo */
+#define OPTIGA_CERT_SIGNATURE_ALGORITHM 7   /**< signatureAlgorithm */
+#define OPTIGA_CERT_SIGNATURE_VALUE     8   /**< signatureValue (BIT STRING) */
+#define OPTIGA_CERT_FIELD_COUNT         9
+
+class OPTIGATrustECertificate
+{
+public:
+    //constructor
+    OPTIGATrustECertificate(const uint8_t* certificate, uint32_t length);
+
+    /**
+     * @brief Returns a complete field including its tag and length, e.g. to compare names or hash the TBSCertificate.
+     *
+     * @param[in]  field        One of OPTIGA_CERT_*.
+     * @param[out] element      Pointer to the tag of the field.
+     * @param[out] length       Length of the field including tag and length.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If the certificate is not valid DER up to this field.
+     */
+    uint16_t getElement(uint8_t field, const uint8_t*& element, uint16_t& length);
+
+    /**
+     * @brief Returns the content of a field without its tag and length.
+     *
+     * @param[in]  field        One of OPTIGA_CERT_*.
+     * @param[out] content      Pointer to the content of the field.
+     * @param[out] length       Length of the content.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+     * @retval  IFX_I2C_STACK_ERROR If the certificate is not valid DER up to this field.
+     */
+    uint16_t getContent(uint8_t field, const uint8_t*& content, uint16_t& length);
+
+    /**
+     * @brief Returns the serial number (big endian, including a leading zero if present).
+     */
+    uint16_t getSerialNumber(const uint8_t*& serial, uint16_t& length);
+
+    /**
+     * @brief Returns notBefore and notAfter as encoded (UTCTime "YYMMDDHHMMSSZ" or GeneralizedTime).
+     */
+    uint16_t getValidity(const uint8_t*& notBefore, uint8_t& notBeforeLength,
+                         const uint8_t*& notAfter, uint8_t& notAfterLength);
+
+    /**
+     * @brief Returns the subject public key, for an EC key the point (0x04 followed by x and y).
+     */
+    uint16_t getPublicKey(const uint8_t*& key, uint16_t& length);
+
+    /**
+     * @brief Returns the signature of the issuer, for ECDSA the DER signature (see OPTIGATrustE::decodeSignature).
+     */
+    uint16_t getSignature(const uint8_t*& signature, uint16_t& length);
+
+private:
+    const uint8_t* m_certificate;
+    uint16_t m_length;
+    // Offset of the tag, offset and length of the content of each field located so far
+    uint16_t m_element[OPTIGA_CERT_FIELD_COUNT];
+    uint16_t m_content[OPTIGA_CERT_FIELD_COUNT];
+    uint16_t m_contentLength[OPTIGA_CERT_FIELD_COUNT];
+    // Number of fields located, position of the next element to decode
+    uint8_t m_located;
+    uint16_t m_position;
+    uint8_t m_invalid;
+
+    uint16_t locate(uint8_t field);
+    uint16_t getBitString(uint16_t position, uint16_t end, const uint8_t*& bits, uint16_t& length);
+};
+/**
+* @}
+*/
+
+
+#endif /* OPTIGATRUSTECERTIFICATE_H_ */
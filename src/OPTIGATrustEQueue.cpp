@@ -0,0 +1,324 @@
+/*
+* Copyright (c) 2017, Infineon Technologies AG
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1.  Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*
+* 2.  Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+* 3.  Neither the name of the copyright holder nor the names of its contributors
+*     may be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include "OPTIGATrustEQueue.h"
+
+// Minimal length of a single random number request to the device
+#define OPTIGA_RANDOM_MIN_LEN                   8
+// Maximal length of a single random number request to the device
+#define OPTIGA_RANDOM_MAX_LEN                   256
+
+OPTIGATrustEQueue::OPTIGATrustEQueue(OPTIGATrustE& trustE) :
+    m_trustE(trustE), m_head(NULL), m_tail(NULL)
+{
+
+}
+
+/**
+ * This function marks a job as pending, before its fields are written. A job that is still
+ * pending is left untouched, it may be queued already.
+ */
+uint16_t OPTIGATrustEQueue::reserve(OPTIGATrustEJob& job)
+{
+    OPTIGA_QUEUE_LOCK();
+    if (job.state == OPTIGA_JOB_STATE_PENDING)
+    {
+        OPTIGA_QUEUE_UNLOCK();
+        return IFX_I2C_STACK_ERROR;
+    }
+    job.state = OPTIGA_JOB_STATE_PENDING;
+    OPTIGA_QUEUE_UNLOCK();
+
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+/**
+ * This function appends a job reserved with reserve() to the end of the queue
+ */
+void OPTIGATrustEQueue::enqueue(OPTIGATrustEJob& job)
+{
+    OPTIGA_QUEUE_LOCK();
+    job.next = NULL;
+    if (m_tail)
+    {
+        m_tail->next = &job;
+    }
+    else
+    {
+        m_head = &job;
+    }
+    m_tail = &job;
+    OPTIGA_QUEUE_UNLOCK();
+}
+
+/**
+ * This function removes the first job from the queue
+ */
+OPTIGATrustEJob* OPTIGATrustEQueue::dequeue(void)
+{
+    OPTIGATrustEJob* job;
+
+    OPTIGA_QUEUE_LOCK();
+    job = m_head;
+    if (job)
+    {
+        m_head = job->next;
+        if (m_head == NULL)
+        {
+            m_tail = NULL;
+        }
+        job->next = NULL;
+    }
+    OPTIGA_QUEUE_UNLOCK();
+
+    return job;
+}
+
+/**
+ * This function removes the first pending random job which fits into maxLength from the queue
+ */
+OPTIGATrustEJob* OPTIGATrustEQueue::dequeueRandom(uint16_t maxLength)
+{
+    OPTIGATrustEJob* job;
+    OPTIGATrustEJob* prev = NULL;
+
+    OPTIGA_QUEUE_LOCK();
+    for (job = m_head; job; prev = job, job = job->next)
+    {
+        if (job->type == OPTIGA_JOB_RANDOM && job->outputLength <= maxLength)
+        {
+            if (prev)
+            {
+                prev->next = job->next;
+            }
+            else
+            {
+                m_head = job->next;
+            }
+            if (m_tail == job)
+            {
+                m_tail = prev;
+            }
+            job->next = NULL;
+            break;
+        }
+    }
+    OPTIGA_QUEUE_UNLOCK();
+
+    return job;
+}
+
+/**
+ * This function stores the result of a job and notifies the submitter
+ */
+void OPTIGATrustEQueue::complete(OPTIGATrustEJob* job, uint16_t status)
+{
+    job->status = status;
+    job->state = OPTIGA_JOB_STATE_DONE;
+    if (job->callback)
+    {
+        job->callback(job);
+    }
+}
+
+uint16_t OPTIGATrustEQueue::submitRandom(OPTIGATrustEJob& job, uint16_t length, uint8_t p_random[],
+                                         OPTIGATrustEJobCallback callback, void* context)
+{
+    if (p_random == NULL || length < OPTIGA_RANDOM_MIN_LEN || length > OPTIGA_RANDOM_MAX_LEN)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    if (reserve(job))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    job.type = OPTIGA_JOB_RANDOM;
+    job.input = NULL;
+    job.inputLength = 0;
+    job.output = p_random;
+    job.outputLength = length;
+    job.callback = callback;
+    job.context = context;
+    enqueue(job);
+
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t OPTIGATrustEQueue::submitSignature(OPTIGATrustEJob& job, uint8_t p_message[], uint16_t message_length,
+                                            uint8_t pp_signature[], uint16_t signature_size,
+                                            OPTIGATrustEJobCallback callback, void* context)
+{
+    if (p_message == NULL || pp_signature == NULL)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    if (reserve(job))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    job.type = OPTIGA_JOB_SIGNATURE;
+    job.input = p_message;
+    job.inputLength = message_length;
+    job.output = pp_signature;
+    job.outputLength = signature_size;
+    job.callback = callback;
+    job.context = context;
+    enqueue(job);
+
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t OPTIGATrustEQueue::submitApdu(OPTIGATrustEJob& job, uint8_t apdu[], uint16_t length, uint8_t response[],
+                                       uint16_t responseSize, OPTIGATrustEJobCallback callback, void* context)
+{
+    if (apdu == NULL)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    if (reserve(job))
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    job.type = OPTIGA_JOB_APDU;
+    job.input = apdu;
+    job.inputLength = length;
+    job.output = response;
+    job.outputLength = (response != NULL) ? responseSize : 0;
+    job.callback = callback;
+    job.context = context;
+    enqueue(job);
+
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+/**
+ * This function serves the given random job together with all other pending random jobs
+ * that fit into one device command
+ */
+uint16_t OPTIGATrustEQueue::processRandom(OPTIGATrustEJob* job)
+{
+    uint8_t random[OPTIGA_QUEUE_RANDOM_BATCH];
+    OPTIGATrustEJob* batch = job;
+    OPTIGATrustEJob* last = job;
+    OPTIGATrustEJob* next;
+    uint16_t total = job->outputLength;
+    uint16_t pos = 0;
+    uint16_t count = 0;
+    uint16_t status;
+
+    // Collect further random jobs as long as they fit into the batch
+    while (total < OPTIGA_QUEUE_RANDOM_BATCH
+           && (next = dequeueRandom(OPTIGA_QUEUE_RANDOM_BATCH - total)) != NULL)
+    {
+        last->next = next;
+        last = next;
+        total += next->outputLength;
+    }
+
+    if (batch == last)
+    {
+        // Single job, no need for the intermediate buffer
+        complete(job, m_trustE.getRandom(job->outputLength, job->output));
+        return 1;
+    }
+
+    status = m_trustE.getRandom(total, random);
+    for (job = batch; job; job = next)
+    {
+        next = job->next;
+        job->next = NULL;
+        if (status == IFX_I2C_STACK_SUCCESS)
+        {
+            memcpy(job->output, random + pos, job->outputLength);
+            pos += job->outputLength;
+        }
+        complete(job, status);
+        count++;
+    }
+
+    // Do not leave random data used by the callers on the stack
+    memset(random, 0x00, sizeof(random));
+
+    return count;
+}
+
+uint16_t OPTIGATrustEQueue::process(void)
+{
+    OPTIGATrustEJob* job;
+    uint16_t completed = 0;
+    uint16_t status;
+
+    while ((job = dequeue()) != NULL)
+    {
+        switch (job->type)
+        {
+            case OPTIGA_JOB_RANDOM:
+                completed += processRandom(job);
+                continue;
+            case OPTIGA_JOB_SIGNATURE:
+                status = m_trustE.getSignature(job->input, job->inputLength, job->output,
+                                               (uint16_t)job->outputLength, job->outputLength);
+                complete(job, status);
+                break;
+            case OPTIGA_JOB_APDU:
+                status = m_trustE.transceive(job->input, job->inputLength, job->output,
+                                             (uint16_t)job->outputLength, job->outputLength);
+                complete(job, status);
+                break;
+            default:
+                complete(job, IFX_I2C_STACK_ERROR);
+                break;
+        }
+        completed++;
+    }
+
+    return completed;
+}
+
+uint16_t OPTIGATrustEQueue::pending(void)
+{
+    OPTIGATrustEJob* job;
+    uint16_t count = 0;
+
+    OPTIGA_QUEUE_LOCK();
+    for (job = m_head; job; job = job->next)
+    {
+        count++;
+    }
+    OPTIGA_QUEUE_UNLOCK();
+
+    return count;
+}
@@ -0,0 +1,215 @@
+/*
+* Copyright (c) 2017, Infineon Technologies AG
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1.  Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*
+* 2.  Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+* 3.  Neither the name of the copyright holder nor the names of its contributors
+*     may be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#ifndef OPTIGATRUSTEQUEUE_H_
+#define OPTIGATRUSTEQUEUE_H_
+
+#include "OPTIGATrustE.h"
+
+/**
+ * @defgroup ifx_optiga_queue Infineon OPTIGA Trust E Command Queue
+ * @{
+ * @ingroup ifx_optiga
+ *
+ * @brief Module to share one OPTIGA Trust E device between several tasks.
+ *
+ * Callers submit jobs from any task or interrupt, a single worker calling
+ * process() owns the protocol stack and executes the jobs one after another.
+ * Results are reported through the job itself (poll isDone()) or a callback.
+ * The queue is protected by OPTIGA_QUEUE_LOCK and OPTIGA_QUEUE_UNLOCK, see OPTIGATrustE.h.
+ *
+ * process() runs each job to the end. OPTIGATrustE::poll() serves the queue of OPTIGATrustE::queueSignature,
+ * OPTIGATrustE::queueReadObject and OPTIGATrustE::queueTransceive without blocking instead. Both take the
+ * same lock and claim the protocol stack for each command, a job waits for a queued command being sent.
+ */
+
+/** @brief Maximum number of random bytes fetched at once for coalesced getRandom jobs (8 to 256) */
+#ifndef OPTIGA_QUEUE_RANDOM_BATCH
+#if defined(__AVR__)
+#define OPTIGA_QUEUE_RANDOM_BATCH       64
+#else
+#define OPTIGA_QUEUE_RANDOM_BATCH       256
+#endif
+#endif
+
+/** @brief Job types */
+#define OPTIGA_JOB_RANDOM               0x01
+#define OPTIGA_JOB_SIGNATURE            0x02
+#define OPTIGA_JOB_APDU                 0x03
+
+/** @brief Job states */
+#define OPTIGA_JOB_STATE_IDLE           0x00
+#define OPTIGA_JOB_STATE_PENDING        0x01
+#define OPTIGA_JOB_STATE_DONE           0x02
+
+struct OPTIGATrustEJob;
+
+/**
+ * @brief Callback invoked by the worker once a job has been executed.
+ *
+ * The callback runs in the context of the task calling process().
+ */
+typedef void (*OPTIGATrustEJobCallback)(OPTIGATrustEJob* job);
+
+/**
+ * @brief A single request to the OPTIGA Trust E.
+ *
+ * The job is owned by the caller and must stay valid until it is done.
+ * It is filled in by one of the submit functions of @ref OPTIGATrustEQueue.
+ */
+struct OPTIGATrustEJob
+{
+    /** Job type (OPTIGA_JOB_*) */
+    uint8_t type;
+    /** Job state (OPTIGA_JOB_STATE_*) */
+    volatile uint8_t state;
+    /** Result of the job, IFX_I2C_STACK_SUCCESS or IFX_I2C_STACK_ERROR */
+    volatile uint16_t status;
+    /** Input data (message to sign or command APDU) */
+    uint8_t* input;
+    /** Length of the input data */
+    uint16_t inputLength;
+    /** Buffer receiving the result */
+    uint8_t* output;
+    /** Requested length or size of output before, actual length of the result after execution */
+    uint32_t outputLength;
+    /** Callback invoked after execution, may be NULL */
+    OPTIGATrustEJobCallback callback;
+    /** User context for the callback */
+    void* context;
+    /** Next job in the queue */
+    OPTIGATrustEJob* next;
+
+    //constructor
+    OPTIGATrustEJob() : state(OPTIGA_JOB_STATE_IDLE), status(IFX_I2C_STACK_SUCCESS), next(NULL) {}
+
+    /**
+     * @brief Returns true once the worker has executed the job.
+     */
+    bool isDone(void) const { return state == OPTIGA_JOB_STATE_DONE; }
+};
+
+class OPTIGATrustEQueue
+{
+public:
+    //constructor
+    OPTIGATrustEQueue(OPTIGATrustE& trustE);
+
+    /**
+     * @brief Queue a request for a random number.
+     *
+     * Pending random requests are coalesced and served from a single device command
+     * of up to OPTIGA_QUEUE_RANDOM_BATCH bytes.
+     *
+     * @param[in]  job          Job to be queued.
+     * @param[in]  length       Length of the random number (range 8 to 256).
+     * @param[out] p_random     Buffer to store the data.
+     * @param[in]  callback     Function called after execution, may be NULL.
+     * @param[in]  context      User context passed along with the job.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If the job was queued.
+     * @retval  IFX_I2C_STACK_ERROR If the arguments are invalid or the job is still pending.
+     */
+    uint16_t submitRandom(OPTIGATrustEJob& job, uint16_t length, uint8_t p_random[],
+                          OPTIGATrustEJobCallback callback = NULL, void* context = NULL);
+
+    /**
+     * @brief Queue a request for a signature.
+     *
+     * The message is signed with the authentication scheme set with @ref OPTIGATrustE::setAuthScheme.
+     * Setting the message and retrieving the signature is executed without interruption by other jobs.
+     *
+     * @param[in]  job              Job to be queued.
+     * @param[in]  p_message        Message to be signed, must stay valid until the job is done.
+     * @param[in]  message_length   Length of the message (16).
+     * @param[out] pp_signature     Buffer to store the signature.
+     * @param[in]  signature_size   Size of pp_signature (72 bytes hold every signature).
+     * @param[in]  callback         Function called after execution, may be NULL.
+     * @param[in]  context          User context passed along with the job.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If the job was queued.
+     * @retval  IFX_I2C_STACK_ERROR If the arguments are invalid or the job is still pending.
+     */
+    uint16_t submitSignature(OPTIGATrustEJob& job, uint8_t p_message[], uint16_t message_length,
+                             uint8_t pp_signature[], uint16_t signature_size,
+                             OPTIGATrustEJobCallback callback = NULL, void* context = NULL);
+
+    /**
+     * @brief Queue a raw command APDU.
+     *
+     * @param[in]  job          Job to be queued.
+     * @param[in]  apdu         Complete command APDU, must stay valid until the job is done.
+     * @param[in]  length       Length of the command APDU.
+     * @param[out] response     Buffer to store the response data, may be NULL.
+     * @param[in]  responseSize Size of response, a longer response fails the job.
+     * @param[in]  callback     Function called after execution, may be NULL.
+     * @param[in]  context      User context passed along with the job.
+     *
+     * @retval  IFX_I2C_STACK_SUCCESS If the job was queued.
+     * @retval  IFX_I2C_STACK_ERROR If the arguments are invalid or the job is still pending.
+     */
+    uint16_t submitApdu(OPTIGATrustEJob& job, uint8_t apdu[], uint16_t length, uint8_t response[],
+                        uint16_t responseSize, OPTIGATrustEJobCallback callback = NULL, void* context = NULL);
+
+    /**
+     * @brief Execute all pending jobs.
+     *
+     * Must only be called from a single worker task (e.g. the Arduino loop()).
+     *
+     * @retval  Number of jobs completed by this call.
+     */
+    uint16_t process(void);
+
+    /**
+     * @brief Returns the number of jobs waiting for execution.
+     */
+    uint16_t pending(void);
+
+private:
+    OPTIGATrustE& m_trustE;
+    OPTIGATrustEJob* volatile m_head;
+    OPTIGATrustEJob* volatile m_tail;
+
+    uint16_t reserve(OPTIGATrustEJob& job);
+    void enqueue(OPTIGATrustEJob& job);
+    OPTIGATrustEJob* dequeue(void);
+    OPTIGATrustEJob* dequeueRandom(uint16_t maxLength);
+    void complete(OPTIGATrustEJob* job, uint16_t status);
+    uint16_t processRandom(OPTIGATrustEJob* job);
+};
+/**
+* @}
+*/
+
+
+#endif /* OPTIGATRUSTEQUEUE_H_ */
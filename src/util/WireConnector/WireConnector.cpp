@@ -5,6 +5,20 @@
 
 extern TwoWire *OptigaWire;
 
+// Number of bytes the Wire library transfers in one transaction, can be set for the build if not detected
+#if defined(OPTIGA_WIRE_BUFFER_LENGTH)
+#elif defined(I2C_BUFFER_LENGTH)            // ESP32, ESP8266
+#define OPTIGA_WIRE_BUFFER_LENGTH I2C_BUFFER_LENGTH
+#elif defined(WIRE_BUFFER_SIZE)             // RP2040 (arduino-pico)
+#define OPTIGA_WIRE_BUFFER_LENGTH WIRE_BUFFER_SIZE
+#elif defined(ARDUINO_ARCH_SAMD) || defined(ARDUINO_ARCH_MBED) // ring buffers of 256 bytes
+#define OPTIGA_WIRE_BUFFER_LENGTH 256
+#elif defined(BUFFER_LENGTH)                // AVR, Teensy, XMC
+#define OPTIGA_WIRE_BUFFER_LENGTH BUFFER_LENGTH
+#else
+#define OPTIGA_WIRE_BUFFER_LENGTH 32
+#endif
+
 extern "C" {
 #endif
 
@@ -27,12 +41,13 @@ uint8_t Wire_endTransmission(uint8_t sendStop){
 	return OptigaWire->endTransmission(sendStop);
 }
 
-uint8_t Wire_write(const uint8_t* buf, uint8_t size){
-	return OptigaWire->write(buf, size);
+uint16_t Wire_write(const uint8_t* buf, uint16_t size){
+	return OptigaWire->write(buf, (size_t)size);
 }
 
-uint8_t Wire_requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop){
-	return OptigaWire->requestFrom(address, quantity, sendStop);
+uint16_t Wire_requestFrom(uint8_t address, uint16_t quantity, uint8_t sendStop){
+	// The int overload is available on all cores and is not limited to 255 bytes
+	return OptigaWire->requestFrom((int)address, (int)quantity, (int)sendStop);
 }
 
 int Wire_available(void){
@@ -47,6 +62,10 @@ void Wire_setClock(uint32_t clk){
 	OptigaWire->setClock(clk);
 }
 
+uint16_t Wire_bufferLength(void){
+	return (OPTIGA_WIRE_BUFFER_LENGTH > 0xFFFF) ? 0xFFFF : OPTIGA_WIRE_BUFFER_LENGTH;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,9 +15,9 @@ void Wire_beginTransmission(uint8_t);
 
 uint8_t Wire_endTransmission(uint8_t);
 
-uint8_t Wire_write(const uint8_t*, uint8_t);
+uint16_t Wire_write(const uint8_t*, uint16_t);
 
-uint8_t Wire_requestFrom(uint8_t, uint8_t, uint8_t);
+uint16_t Wire_requestFrom(uint8_t, uint16_t, uint8_t);
 
 int Wire_available(void);
 
@@ -25,6 +25,8 @@ int Wire_read(void);
 
 void Wire_setClock(uint32_t);
 
+uint16_t Wire_bufferLength(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -43,23 +43,38 @@
 #define IFX_I2C_CONFIG_H__
 
 // IFX I2C Protocol Stack configuration
+//
+// All settings are fixed at compile time. Each of them can be overridden by defining it before this
+// header is included, e.g. with a compiler flag (-DDL_MAX_FRAME_SIZE=64) or the build_flags of PlatformIO.
 
 /** @brief I2C slave address of the Infineon device */
+#ifndef IFX_I2C_BASE_ADDR
 #define IFX_I2C_BASE_ADDR           0x30
+#endif
 
 /** @brief Physical Layer: polling interval in microseconds */
+#ifndef PL_POLLING_INVERVAL_US
 #define PL_POLLING_INVERVAL_US      10000
+#endif
 /** @brief Physical Layer: guard time interval in microseconds */
+#ifndef PL_GUARD_TIME_INTERVAL_US
 #define PL_GUARD_TIME_INTERVAL_US   50
+#endif
 /** @brief Physical layer: maximal attempts */
+#ifndef PL_POLLING_MAX_CNT
 #define PL_POLLING_MAX_CNT          200
+#endif
 
 /** @brief Data link layer: maximum frame size */
+#ifndef DL_MAX_FRAME_SIZE
 #define DL_MAX_FRAME_SIZE           32
+#endif
 /** @brief Data link layer: header size */
 #define DL_HEADER_SIZE              5
 /** @brief Data link layer: maximum number of retries in case of transmission error */
+#ifndef DL_MAX_RETRIES
 #define DL_MAX_RETRIES              3
+#endif
 
 // Transport Layer settings
 /** @brief Transport layer: maximum fragment size */
@@ -67,7 +82,93 @@
 /** @brief Transport layer: size of internal buffer
  *  @note Should be large enough to store an X.509 certificate
  */
+#ifndef TL_BUFFER_SIZE
 #define TL_BUFFER_SIZE              0x40A
+#endif
+/** @brief Transport layer: pass received fragments directly to the upper layer instead of
+ *  reassembling the response in the internal buffer (set to 0 or 1)
+ *  @note Set to 1 on devices with little RAM, TL_BUFFER_SIZE is not allocated then
+ */
+#ifndef IFX_I2C_TL_STREAMING
+#define IFX_I2C_TL_STREAMING        0
+#endif
+
+/** @brief Event queue: number of HAL events that can be pending
+ *  @note The layers have at most one I2C transfer or timer outstanding, larger values are for HAL ports
+ *  that post events from interrupts
+ */
+#ifndef IFX_I2C_EVENT_QUEUE_SIZE
+#define IFX_I2C_EVENT_QUEUE_SIZE    2
+#endif
+
+/** @brief Fault injection between the HAL and the device for testing the recovery (set to 0 or 1)
+ *  @note See ifx_i2c_fault.h, not for production builds
+ */
+#ifndef IFX_I2C_FAULT_INJECTION
+#define IFX_I2C_FAULT_INJECTION     0
+#endif
+/** @brief Fault injection: number of reads of the I2C_STATE register an injected busy flag stays set */
+#ifndef IFX_I2C_FAULT_BUSY_POLLS
+#define IFX_I2C_FAULT_BUSY_POLLS    5
+#endif
+/** @brief Recording of every I2C transaction of the HAL to a binary log (set to 0 or 1)
+ *  @note See ifx_i2c_record.h
+ */
+#ifndef IFX_I2C_RECORD
+#define IFX_I2C_RECORD              0
+#endif
+/** @brief Replay HAL that answers the stack from a recorded log instead of the device (set to 0 or 1)
+ *  @note Replaces the Arduino HAL, see ifx_i2c_record.h
+ */
+#ifndef IFX_I2C_HAL_REPLAY
+#define IFX_I2C_HAL_REPLAY          0
+#endif
+/** @brief Linux HAL on an i2c-dev bus, completing transfers and timers from a thread of its own (set to 0 or 1)
+ *  @note Replaces the Arduino HAL, reference for interrupt driven ports, see ifx_i2c_hal_linux.c
+ */
+#ifndef IFX_I2C_HAL_LINUX
+#define IFX_I2C_HAL_LINUX           0
+#endif
+/** @brief Linux HAL: I2C bus the device is connected to */
+#ifndef IFX_I2C_HAL_LINUX_DEVICE
+#define IFX_I2C_HAL_LINUX_DEVICE    "/dev/i2c-1"
+#endif
+
+// Reject configurations the protocol stack cannot work with
+#if PL_POLLING_INVERVAL_US > 0xFFFF || PL_GUARD_TIME_INTERVAL_US > 0xFFFF
+#error "PL_POLLING_INVERVAL_US and PL_GUARD_TIME_INTERVAL_US must not exceed 65535"
+#endif
+#if PL_POLLING_MAX_CNT < 1 || PL_POLLING_MAX_CNT > 0xFF
+#error "PL_POLLING_MAX_CNT must be in the range 1 to 255"
+#endif
+#if DL_MAX_FRAME_SIZE < (DL_HEADER_SIZE + 2) || DL_MAX_FRAME_SIZE > 0xFFFF
+#error "DL_MAX_FRAME_SIZE must hold the data link header and at least one transport layer byte"
+#endif
+#if IFX_I2C_EVENT_QUEUE_SIZE < 1 || IFX_I2C_EVENT_QUEUE_SIZE > 0xFE
+#error "IFX_I2C_EVENT_QUEUE_SIZE must be in the range 1 to 254"
+#endif
+#if IFX_I2C_FAULT_BUSY_POLLS < 1 || IFX_I2C_FAULT_BUSY_POLLS > 0xFF
+#error "IFX_I2C_FAULT_BUSY_POLLS must be in the range 1 to 255"
+#endif
+#if IFX_I2C_TL_STREAMING == 0 && TL_BUFFER_SIZE < TL_MAX_FRAGMENT_SIZE
+#error "TL_BUFFER_SIZE must hold at least one fragment"
+#endif
+#if IFX_I2C_HAL_REPLAY && IFX_I2C_HAL_LINUX
+#error "Only one of IFX_I2C_HAL_REPLAY and IFX_I2C_HAL_LINUX can be set"
+#endif
+
+/** @brief Static RAM used by the buffers of the physical layer in bytes */
+#define IFX_I2C_PL_BUFFER_RAM       (1 + DL_MAX_FRAME_SIZE)
+/** @brief Static RAM used by the buffers of the data link layer in bytes */
+#define IFX_I2C_DL_BUFFER_RAM       (2 * DL_MAX_FRAME_SIZE)
+/** @brief Static RAM used by the buffers of the transport layer in bytes */
+#if IFX_I2C_TL_STREAMING == 0
+#define IFX_I2C_TL_BUFFER_RAM       (TL_BUFFER_SIZE)
+#else
+#define IFX_I2C_TL_BUFFER_RAM       (TL_MAX_FRAGMENT_SIZE)
+#endif
+/** @brief Static RAM used by all buffers of the protocol stack in bytes */
+#define IFX_I2C_STACK_BUFFER_RAM    (IFX_I2C_PL_BUFFER_RAM + IFX_I2C_DL_BUFFER_RAM + IFX_I2C_TL_BUFFER_RAM)
 
 /** @brief Protocol Stack status codes for success */
 #define IFX_I2C_STACK_SUCCESS       0x00
@@ -75,13 +176,21 @@
 #define IFX_I2C_STACK_ERROR         0x01
 
 /** @brief Protocol Stack debug switch for physical layer (set to 0 or 1) */
+#ifndef IFX_I2C_LOG_PL
 #define IFX_I2C_LOG_PL              0
+#endif
 /** @brief Protocol Stack debug switch for data link layer (set to 0 or 1) */
+#ifndef IFX_I2C_LOG_DL
 #define IFX_I2C_LOG_DL              0
+#endif
 /** @brief Protocol Stack debug switch for transport layer (set to 0 or 1) */
+#ifndef IFX_I2C_LOG_TL
 #define IFX_I2C_LOG_TL              0
+#endif
 /** @brief Protocol Stack debug switch for hardware abstraction layer (set to 0 or 1) */
+#ifndef IFX_I2C_LOG_HAL
 #define IFX_I2C_LOG_HAL             0
+#endif
 
 /** @brief Log ID number for physical layer */
 #define IFX_I2C_LOG_ID_PL           0x00
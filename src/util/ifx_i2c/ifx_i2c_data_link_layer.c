@@ -43,6 +43,7 @@
 #define DL_STATE_TX    0x02
 #define DL_STATE_RX    0x03
 #define DL_STATE_ACK   0x04
+#define DL_STATE_RESYNC 0x05
 
 // Data Link Layer Frame Control Constants
 #define DL_FCTR_CONTROL_FRAME     0x80
@@ -50,6 +51,7 @@
 #define DL_FCTR_SEQCTR_OFFSET     5
 #define DL_FCTR_SEQCTR_VALUE_ACK  0x00
 #define DL_FCTR_SEQCTR_VALUE_NACK 0x01
+#define DL_FCTR_SEQCTR_VALUE_RESYNC 0x02
 #define DL_FCTR_FRNR_MASK         0x0C
 #define DL_FCTR_FRNR_OFFSET       2
 #define DL_FCTR_ACKNR_MASK        0x03
@@ -74,6 +76,9 @@ static uint8_t m_rx_buffer[DL_MAX_FRAME_SIZE];
 static volatile uint16_t m_tx_buffer_size;
 static volatile uint16_t m_rx_buffer_size;
 
+// Data Link layer statistics
+static ifx_i2c_dl_stats_t m_stats;
+
 // Setup debug log statements
 #if IFX_I2C_LOG_DL == 1
 #include "ifx_i2c_hal.h"
@@ -157,6 +162,7 @@ static uint16_t ifx_i2c_dl_send_frame_internal(uint8_t* frame, uint16_t frame_le
     m_tx_buffer[4 + frame_len] = crc;
 
     // Transmit frame
+    m_stats.tx_frames++;
     m_tx_buffer_size = DL_HEADER_SIZE + frame_len;
     return ifx_i2c_pl_send_frame(m_tx_buffer, m_tx_buffer_size);
 }
@@ -169,6 +175,8 @@ static void ifx_i2c_dl_resend_frame(uint8_t seqctr_value)
     if (m_retransmit_counter++ < DL_MAX_RETRIES)
     {
         LOG_DL("[IFX-DL]: Resend Frame\n");
+        m_stats.retransmissions++;
+        m_stats.retransmitted_bytes += m_tx_buffer_size;
         m_state = DL_STATE_TX;
         if (ifx_i2c_dl_send_frame_internal(m_tx_buffer + 3, m_tx_buffer_size - DL_HEADER_SIZE,
             seqctr_value, 1))
@@ -191,11 +199,35 @@ static void ifx_i2c_pl_event_handler(uint8_t event, uint8_t* data, uint16_t data
     uint8_t fctr = 0, fr_nr, ack_nr, seqctr;
     uint16_t packet_len, crc_received, crc_calculated;
 
-    if (m_state == DL_STATE_TX)
+    if (m_state == DL_STATE_RESYNC)
+    {
+        // If writing the re-synchronization frame failed retry, the device does not answer it
+        if (event == IFX_I2C_PL_EVENT_ERROR)
+        {
+            m_stats.pl_errors++;
+            if (m_retransmit_counter++ < DL_MAX_RETRIES)
+            {
+                m_stats.retransmissions++;
+                m_stats.retransmitted_bytes += DL_HEADER_SIZE;
+                if (ifx_i2c_dl_send_frame_internal(0, 0, DL_FCTR_SEQCTR_VALUE_RESYNC, 0) == IFX_I2C_STACK_SUCCESS)
+                {
+                    return;
+                }
+            }
+            m_state = DL_STATE_IDLE;
+            DL_ERROR();
+        }
+
+        // Frame counters of both sides are reset
+        m_state = DL_STATE_IDLE;
+        m_upper_layer_event_handler(IFX_I2C_DL_EVENT_TX_SUCCESS, 0, 0);
+    }
+    else if (m_state == DL_STATE_TX)
     {
         // If writing a frame failed retry sending
         if (event == IFX_I2C_PL_EVENT_ERROR)
         {
+            m_stats.pl_errors++;
             DL_RESEND_FRAME(DL_FCTR_SEQCTR_VALUE_ACK);
         }
 
@@ -211,6 +243,7 @@ static void ifx_i2c_pl_event_handler(uint8_t event, uint8_t* data, uint16_t data
         // If no frame was received retry sending
         if (event == IFX_I2C_PL_EVENT_ERROR)
         {
+            m_stats.pl_errors++;
             DL_RESEND_FRAME(DL_FCTR_SEQCTR_VALUE_NACK);
         }
 
@@ -220,11 +253,13 @@ static void ifx_i2c_pl_event_handler(uint8_t event, uint8_t* data, uint16_t data
         // Check frame length
         if (data_len < DL_HEADER_SIZE)
         {
+            m_stats.crc_errors++;
             DL_RESEND_FRAME(DL_FCTR_SEQCTR_VALUE_NACK);
         }
         packet_len = (data[1] << 8) | data[2];
         if (data_len != DL_HEADER_SIZE + packet_len)
         {
+            m_stats.crc_errors++;
             DL_RESEND_FRAME(DL_FCTR_SEQCTR_VALUE_NACK);
         }
 
@@ -233,8 +268,10 @@ static void ifx_i2c_pl_event_handler(uint8_t event, uint8_t* data, uint16_t data
         crc_calculated = ifx_i2c_dl_calc_crc(data, 3 + packet_len);
         if (crc_received != crc_calculated)
         {
+            m_stats.crc_errors++;
             DL_RESEND_FRAME(DL_FCTR_SEQCTR_VALUE_NACK);
         }
+        m_stats.rx_frames++;
 
         // Check transmit frame sequence number
         fctr = data[0];
@@ -242,6 +279,7 @@ static void ifx_i2c_pl_event_handler(uint8_t event, uint8_t* data, uint16_t data
         ack_nr = (fctr & DL_FCTR_ACKNR_MASK) >> DL_FCTR_ACKNR_OFFSET;
         if ((seqctr == DL_FCTR_SEQCTR_VALUE_NACK) && ack_nr == m_tx_seq_nr)
         {
+            m_stats.nacks++;
             DL_RESEND_FRAME(DL_FCTR_SEQCTR_VALUE_NACK);
         }
         if ((seqctr != DL_FCTR_SEQCTR_VALUE_ACK) || ack_nr != m_tx_seq_nr)
@@ -293,6 +331,7 @@ static void ifx_i2c_pl_event_handler(uint8_t event, uint8_t* data, uint16_t data
         // If writing the ACK frame failed retry
         if (event == IFX_I2C_PL_EVENT_ERROR)
         {
+            m_stats.pl_errors++;
             DL_RESEND_FRAME(DL_FCTR_SEQCTR_VALUE_ACK)
         }
 
@@ -366,3 +405,42 @@ uint16_t ifx_i2c_dl_receive_frame(void)
 
     return ifx_i2c_pl_receive_frame();
 }
+
+uint16_t ifx_i2c_dl_resync(void)
+{
+    LOG_DL("[IFX-DL]: Re-synchronize\n");
+
+    // Allowed in any state after initialization, the frame counters may be out of step after an error
+    if (m_state == DL_STATE_UINIT)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    m_state = DL_STATE_RESYNC;
+    m_retransmit_counter = 0;
+    m_tx_seq_nr = DL_MAX_FRAME_NUM - 1;
+    m_rx_seq_nr = DL_MAX_FRAME_NUM - 1;
+    if (ifx_i2c_dl_send_frame_internal(0, 0, DL_FCTR_SEQCTR_VALUE_RESYNC, 0))
+    {
+        m_state = DL_STATE_IDLE;
+        return IFX_I2C_STACK_ERROR;
+    }
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+uint16_t ifx_i2c_dl_get_max_payload(void)
+{
+    return ifx_i2c_pl_get_frame_size() - DL_HEADER_SIZE;
+}
+
+void ifx_i2c_dl_get_stats(ifx_i2c_dl_stats_t* stats, uint8_t reset)
+{
+    if (stats)
+    {
+        *stats = m_stats;
+    }
+    if (reset)
+    {
+        memset(&m_stats, 0, sizeof(m_stats));
+    }
+}
@@ -53,6 +53,28 @@
 /** @brief Receive success event propagated to upper layer */
 #define IFX_I2C_DL_EVENT_RX_SUCCESS         0x04
 
+/**
+ * @brief Statistics of the data link layer.
+ *
+ * The counters wrap around, differences between two readings stay valid.
+ */
+typedef struct
+{
+    /** @brief Data and control frames handed to the physical layer, including retransmissions */
+    uint16_t tx_frames;
+    /** @brief Frames received with valid length and CRC */
+    uint16_t rx_frames;
+    /** @brief Frames received with invalid length or CRC */
+    uint16_t crc_errors;
+    /** @brief NACKs received from the device */
+    uint16_t nacks;
+    /** @brief Failed physical layer transfers (no acknowledge, device busy for too long) */
+    uint16_t pl_errors;
+    /** @brief Frames sent again after an error */
+    uint16_t retransmissions;
+    /** @brief Bytes of the frames sent again, including the data link header */
+    uint32_t retransmitted_bytes;
+} ifx_i2c_dl_stats_t;
 
 /**
  * @brief Function for initializing the module.
@@ -95,6 +117,34 @@ uint16_t ifx_i2c_dl_send_frame(uint8_t* frame, uint16_t frame_len);
  */
 uint16_t ifx_i2c_dl_receive_frame(void);
 
+/**
+ * @brief Function for re-synchronizing the frame counters.
+ *
+ * Asynchronous function to send a re-synchronization control frame, which resets the frame
+ * and acknowledge numbers on both sides. It may be called in any state after an error has been
+ * reported, the device keeps its application context. IFX_I2C_DL_EVENT_TX_SUCCESS or
+ * IFX_I2C_DL_EVENT_ERROR is propagated to the event handler registered with @ref ifx_i2c_dl_init.
+ *
+ * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+ * @retval  IFX_I2C_STACK_ERROR If the module is not initialized or the physical layer is busy.
+ */
+uint16_t ifx_i2c_dl_resync(void);
+
+/**
+ * @brief Function for reading the maximum payload of a frame.
+ *
+ * @return  Frame size of the physical layer minus the data link header.
+ */
+uint16_t ifx_i2c_dl_get_max_payload(void);
+
+/**
+ * @brief Function for reading the statistics of the module.
+ *
+ * @param[out] stats  Counters since the last reset, may be NULL.
+ * @param[in]  reset  If 1, the counters are cleared after reading.
+ */
+void ifx_i2c_dl_get_stats(ifx_i2c_dl_stats_t* stats, uint8_t reset);
+
 /**
  * @}
  **/
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// IFX I2C Protocol Stack - Event Queue (source file)
+
+#include "ifx_i2c_event.h"
+#include <stddef.h> // NULL
+
+// Queued event, a timer expiry if callback is set, a HAL event otherwise
+typedef struct
+{
+    IFX_I2C_EventHandler handler;
+    IFX_Timer_Callback   callback;
+    uint8_t              event;
+} ifx_i2c_event_t;
+
+// Event queue (ring buffer with one unused slot). The producer (HAL, possibly an interrupt) only
+// writes m_tail, the consumer (dispatch loop) only writes m_head, so no locking is required.
+#define EVENT_QUEUE_SLOTS (IFX_I2C_EVENT_QUEUE_SIZE + 1)
+
+// The volatile accesses keep their order on a single core. A HAL posting from a thread that may run on
+// another core publishes an entry with a release store of the index, read back with an acquire load.
+#if IFX_I2C_HAL_LINUX
+#define EVENT_LOAD(index)           __atomic_load_n(&(index), __ATOMIC_ACQUIRE)
+#define EVENT_STORE(index, value)   __atomic_store_n(&(index), (value), __ATOMIC_RELEASE)
+#else
+#define EVENT_LOAD(index)           (index)
+#define EVENT_STORE(index, value)   ((index) = (value))
+#endif
+
+static volatile ifx_i2c_event_t m_queue[EVENT_QUEUE_SLOTS];
+static volatile uint8_t  m_head;
+static volatile uint8_t  m_tail;
+
+// Stack position of the running dispatch, NULL outside of ifx_i2c_event_dispatch()
+static volatile uint8_t* m_dispatch_stack;
+
+// Statistics
+static ifx_i2c_event_stats_t m_stats;
+
+static uint16_t ifx_i2c_event_push(IFX_I2C_EventHandler handler, IFX_Timer_Callback callback, uint8_t event)
+{
+    uint8_t tail = m_tail;
+    uint8_t head = EVENT_LOAD(m_head);
+    uint8_t next = (tail + 1) % EVENT_QUEUE_SLOTS;
+    uint8_t pending;
+
+    if (next == head)
+    {
+        if (m_stats.overflows < 0xFF)
+        {
+            m_stats.overflows++;
+        }
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    // Fill the entry before publishing it by moving the tail
+    m_queue[tail].handler  = handler;
+    m_queue[tail].callback = callback;
+    m_queue[tail].event    = event;
+    EVENT_STORE(m_tail, next);
+
+    pending = (next + EVENT_QUEUE_SLOTS - head) % EVENT_QUEUE_SLOTS;
+    if (pending > m_stats.max_pending)
+    {
+        m_stats.max_pending = pending;
+    }
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+void ifx_i2c_event_init(void)
+{
+    m_head = m_tail;
+}
+
+uint16_t ifx_i2c_event_post(IFX_I2C_EventHandler handler, uint8_t event)
+{
+    if (handler == NULL)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    return ifx_i2c_event_push(handler, NULL, event);
+}
+
+uint16_t ifx_i2c_event_post_timer(IFX_Timer_Callback callback)
+{
+    if (callback == NULL)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    return ifx_i2c_event_push(NULL, callback, 0);
+}
+
+uint8_t ifx_i2c_event_dispatch(void)
+{
+    uint8_t marker;
+    uint8_t head = m_head;
+    IFX_I2C_EventHandler handler;
+    IFX_Timer_Callback callback;
+    uint8_t event;
+
+    // Let a polled HAL complete its transfer or timer
+    if (head == EVENT_LOAD(m_tail))
+    {
+        ifx_i2c_hal_poll();
+        if (head == EVENT_LOAD(m_tail))
+        {
+            return 0;
+        }
+    }
+
+    // Remove the event before delivering it, the handler starts the follow-up operation
+    handler  = m_queue[head].handler;
+    callback = m_queue[head].callback;
+    event    = m_queue[head].event;
+    EVENT_STORE(m_head, (head + 1) % EVENT_QUEUE_SLOTS);
+
+    m_dispatch_stack = &marker;
+    if (callback)
+    {
+        callback();
+    }
+    else
+    {
+        handler(event);
+    }
+    m_dispatch_stack = NULL;
+
+    return 1;
+}
+
+void ifx_i2c_event_mark_stack(void)
+{
+    uint8_t marker;
+    uint16_t depth;
+
+    if (m_dispatch_stack == NULL)
+    {
+        return;
+    }
+
+    // The stack grows downwards on all supported targets
+    depth = (uint16_t)((uintptr_t)m_dispatch_stack - (uintptr_t)&marker);
+    if (depth > m_stats.max_stack_depth)
+    {
+        m_stats.max_stack_depth = depth;
+    }
+}
+
+void ifx_i2c_event_get_stats(ifx_i2c_event_stats_t* stats, uint8_t reset)
+{
+    if (stats)
+    {
+        *stats = m_stats;
+    }
+    if (reset)
+    {
+        m_stats.max_stack_depth = 0;
+        m_stats.max_pending     = 0;
+        m_stats.overflows       = 0;
+    }
+}
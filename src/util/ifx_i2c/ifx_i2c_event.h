@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @defgroup ifx_i2c_event Infineon I2C Protocol Stack: Event Queue
+ * @{
+ * @ingroup ifx_i2c
+ *
+ * @brief Module to dispatch events of the hardware abstraction layer from a single loop.
+ *
+ * The HAL posts the completion of an I2C transfer and the expiry of a timer instead of calling the
+ * physical layer directly. The events are delivered by ifx_i2c_event_dispatch(), so each event
+ * passes the layers once and returns before the next one is processed. The stack depth is then
+ * bounded by one pass through the layers instead of growing with every frame of a chained transfer.
+ *
+ * The queue is the only state shared between the HAL and the protocol layers. Events may be posted
+ * from an interrupt or driver callback while the layers run in the context calling
+ * ifx_i2c_event_dispatch(); the layers are never entered from the posting context.
+ */
+
+
+#ifndef IFX_I2C_EVENT_H__
+#define IFX_I2C_EVENT_H__
+
+
+#include "ifx_i2c_config.h"
+#include "ifx_i2c_hal.h"
+
+
+/**
+ * @brief Statistics of the event queue.
+ */
+typedef struct
+{
+    /** @brief Largest stack depth in bytes between ifx_i2c_event_dispatch() and a HAL function */
+    uint16_t max_stack_depth;
+    /** @brief Largest number of events pending at the same time */
+    uint8_t  max_pending;
+    /** @brief Number of events lost because the queue was full */
+    uint8_t  overflows;
+} ifx_i2c_event_stats_t;
+
+/**
+ * @brief Function for discarding all pending events.
+ *
+ * Called by the HAL when it is (re-)initialized.
+ */
+void ifx_i2c_event_init(void);
+
+/**
+ * @brief Function for posting a HAL event.
+ *
+ * May be called from interrupt context. Posting must not be interrupted by another post; the layers
+ * have only one transfer or timer outstanding, so this holds as long as the HAL posts each completion once.
+ * The event is delivered to the handler registered with ifx_i2c_init() by ifx_i2c_event_dispatch().
+ *
+ * @param[in] handler  Event handler of the physical layer.
+ * @param[in] event    HAL event (IFX_I2C_HAL_TX_SUCCESS, IFX_I2C_HAL_RX_SUCCESS or IFX_I2C_HAL_ERROR).
+ *
+ * @retval  IFX_I2C_STACK_SUCCESS If the event was queued.
+ * @retval  IFX_I2C_STACK_ERROR If the queue is full.
+ */
+uint16_t ifx_i2c_event_post(IFX_I2C_EventHandler handler, uint8_t event);
+
+/**
+ * @brief Function for posting an expired timer.
+ *
+ * May be called from interrupt context, see ifx_i2c_event_post().
+ *
+ * @param[in] callback  Function to be called by ifx_i2c_event_dispatch().
+ *
+ * @retval  IFX_I2C_STACK_SUCCESS If the event was queued.
+ * @retval  IFX_I2C_STACK_ERROR If the queue is full.
+ */
+uint16_t ifx_i2c_event_post_timer(IFX_Timer_Callback callback);
+
+/**
+ * @brief Function for delivering the oldest pending event.
+ *
+ * If no event is pending, ifx_i2c_hal_poll() is called first so that a polled HAL can complete its
+ * operation. Must not be called from interrupt context.
+ *
+ * @retval  1 If an event was delivered.
+ * @retval  0 If no event was pending.
+ */
+uint8_t ifx_i2c_event_dispatch(void);
+
+/**
+ * @brief Function for recording the current stack depth.
+ *
+ * Called by the HAL on entry of its transfer and timer functions. The depth is measured
+ * relative to the stack position of the running ifx_i2c_event_dispatch().
+ */
+void ifx_i2c_event_mark_stack(void);
+
+/**
+ * @brief Function for reading the statistics of the event queue.
+ *
+ * @param[out] stats  Statistics collected since the last reset.
+ * @param[in]  reset  If 1, the statistics are cleared after reading.
+ */
+void ifx_i2c_event_get_stats(ifx_i2c_event_stats_t* stats, uint8_t reset);
+
+/**
+ * @}
+ **/
+
+#endif /* IFX_I2C_EVENT_H__ */
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// IFX I2C Protocol Stack - Fault Injection (source file)
+
+#include "ifx_i2c_fault.h"
+
+#if IFX_I2C_FAULT_INJECTION
+
+#include <string.h> // memset
+
+// Registers and frame fields, see the physical and data link layer
+#define FAULT_REG_DATA          0x80
+#define FAULT_REG_I2C_STATE     0x82
+#define FAULT_I2C_STATE_BUSY    0x80
+#define FAULT_FCTR_CONTROL      0x80
+#define FAULT_FCTR_FRNR_MASK    0x0C
+
+static uint32_t m_random;
+static uint16_t m_rates[IFX_I2C_FAULT_COUNT];
+static uint16_t m_counts[IFX_I2C_FAULT_COUNT];
+static uint8_t  m_register;
+static uint8_t  m_busy_polls;
+
+// Pseudo random generator (xorshift32)
+static uint32_t ifx_i2c_fault_random(void)
+{
+    m_random ^= m_random << 13;
+    m_random ^= m_random >> 17;
+    m_random ^= m_random << 5;
+    return m_random;
+}
+
+// Decides whether a fault of the given class is injected into this transfer
+static uint8_t ifx_i2c_fault_hit(uint8_t fault)
+{
+    if (m_rates[fault] == 0 || (uint16_t)ifx_i2c_fault_random() >= m_rates[fault])
+    {
+        return 0;
+    }
+    m_counts[fault]++;
+    return 1;
+}
+
+// Frame CRC, the same as ifx_i2c_dl_calc_crc
+static uint16_t ifx_i2c_fault_crc(const uint8_t* data, uint16_t data_len)
+{
+    uint16_t crc = 0;
+    uint16_t wh1, wh2, wh3, wh4;
+
+    while (data_len--)
+    {
+        wh1 = (crc ^ *data++) & 0xFF;
+        wh2 = wh1 & 0x0F;
+        wh3 = ((uint16_t)(wh2 << 4)) ^ wh1;
+        wh4 = wh3 >> 4;
+        crc = ((uint16_t)((((uint16_t)((((uint16_t)(wh3 << 1)) ^ wh4) << 4)) ^ wh2) << 3)) ^ wh4 ^ (crc >> 8);
+    }
+    return crc;
+}
+
+void ifx_i2c_fault_init(uint32_t seed)
+{
+    // xorshift does not leave the state 0
+    m_random = seed ? seed : 1;
+    memset(m_rates, 0, sizeof(m_rates));
+    memset(m_counts, 0, sizeof(m_counts));
+    m_busy_polls = 0;
+}
+
+void ifx_i2c_fault_set_rate(uint8_t fault, uint16_t rate)
+{
+    if (fault < IFX_I2C_FAULT_COUNT)
+    {
+        m_rates[fault] = rate;
+    }
+}
+
+void ifx_i2c_fault_get_counts(uint16_t* counts, uint8_t reset)
+{
+    if (counts)
+    {
+        memcpy(counts, m_counts, sizeof(m_counts));
+    }
+    if (reset)
+    {
+        memset(m_counts, 0, sizeof(m_counts));
+    }
+}
+
+uint8_t ifx_i2c_fault_transmit(const uint8_t* data, uint16_t length)
+{
+    if (length == 0)
+    {
+        return IFX_I2C_FAULT_PASS;
+    }
+    if (ifx_i2c_fault_hit(IFX_I2C_FAULT_NACK))
+    {
+        return IFX_I2C_FAULT_FAIL;
+    }
+    m_register = data[0];
+
+    if (m_register == FAULT_REG_DATA && length > 1 && (data[1] & FAULT_FCTR_CONTROL)
+        && ifx_i2c_fault_hit(IFX_I2C_FAULT_DROP_ACK))
+    {
+        return IFX_I2C_FAULT_SKIP;
+    }
+    return IFX_I2C_FAULT_PASS;
+}
+
+void ifx_i2c_fault_receive(uint8_t* data, uint16_t* length)
+{
+    uint16_t frame_len;
+    uint16_t crc;
+
+    if (*length == 0)
+    {
+        return;
+    }
+
+    if (m_register == FAULT_REG_I2C_STATE)
+    {
+        if (m_busy_polls == 0 && ifx_i2c_fault_hit(IFX_I2C_FAULT_BUSY))
+        {
+            m_busy_polls = IFX_I2C_FAULT_BUSY_POLLS;
+        }
+        if (m_busy_polls)
+        {
+            m_busy_polls--;
+            data[0] |= FAULT_I2C_STATE_BUSY;
+        }
+    }
+    else if (m_register == FAULT_REG_DATA)
+    {
+        // Frame: FCTR, length (2 bytes), data, CRC (2 bytes)
+        frame_len = (*length >= 5) ? (data[1] << 8) | data[2] : 0;
+        if (frame_len + 5 == *length && !(data[0] & FAULT_FCTR_CONTROL)
+            && ifx_i2c_fault_hit(IFX_I2C_FAULT_FRAME_NR))
+        {
+            data[0] = (data[0] & ~FAULT_FCTR_FRNR_MASK) | ((data[0] + 4) & FAULT_FCTR_FRNR_MASK);
+            crc = ifx_i2c_fault_crc(data, 3 + frame_len);
+            data[3 + frame_len] = crc >> 8;
+            data[4 + frame_len] = crc;
+        }
+        // After the frame number, so the changed CRC is not recalculated
+        if (ifx_i2c_fault_hit(IFX_I2C_FAULT_CRC))
+        {
+            data[ifx_i2c_fault_random() % *length] ^= 1 << (ifx_i2c_fault_random() & 7);
+        }
+    }
+
+    if (*length > 1 && ifx_i2c_fault_hit(IFX_I2C_FAULT_SHORT_READ))
+    {
+        *length = ifx_i2c_fault_random() % *length;
+    }
+}
+
+#endif /* IFX_I2C_FAULT_INJECTION */
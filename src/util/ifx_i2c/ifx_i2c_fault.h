@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @defgroup ifx_i2c_fault Infineon I2C Protocol Stack: Fault Injection
+ * @{
+ * @ingroup ifx_i2c
+ *
+ * @brief Module to inject transfer faults between the HAL and the device.
+ *
+ * Only compiled with IFX_I2C_FAULT_INJECTION set to 1. The HAL hands each transfer to the module,
+ * which decides with a seeded pseudo random generator whether a fault is injected, so a run can be
+ * repeated exactly. Together with the data link layer statistics this measures how long the stack
+ * needs to recover from each kind of fault and how many bytes it sends again.
+ */
+
+
+#ifndef IFX_I2C_FAULT_H__
+#define IFX_I2C_FAULT_H__
+
+
+#include "ifx_i2c_config.h"
+
+#if IFX_I2C_FAULT_INJECTION
+
+/** @brief A byte of a frame read from the device is changed (CRC error) */
+#define IFX_I2C_FAULT_CRC           0
+/** @brief A control frame written to the device is dropped, the write reports success */
+#define IFX_I2C_FAULT_DROP_ACK      1
+/** @brief The busy flag of the I2C_STATE register stays set for IFX_I2C_FAULT_BUSY_POLLS reads */
+#define IFX_I2C_FAULT_BUSY          2
+/** @brief A write is not acknowledged by the device */
+#define IFX_I2C_FAULT_NACK          3
+/** @brief A read returns fewer bytes than requested */
+#define IFX_I2C_FAULT_SHORT_READ    4
+/** @brief The frame number of a data frame read from the device is changed, the CRC is valid */
+#define IFX_I2C_FAULT_FRAME_NR      5
+/** @brief Number of fault classes */
+#define IFX_I2C_FAULT_COUNT         6
+
+/** @brief Result of ifx_i2c_fault_transmit */
+#define IFX_I2C_FAULT_PASS          0   /**< Write to the device */
+#define IFX_I2C_FAULT_FAIL          1   /**< Report an error without writing */
+#define IFX_I2C_FAULT_SKIP          2   /**< Report success without writing */
+
+/**
+ * @brief Function for seeding the generator, all rates and counters are cleared.
+ *
+ * @param[in] seed  Seed of the generator, runs with the same seed and rates inject the same faults.
+ */
+void ifx_i2c_fault_init(uint32_t seed);
+
+/**
+ * @brief Function for setting the probability of a fault class.
+ *
+ * @param[in] fault  IFX_I2C_FAULT_CRC ... IFX_I2C_FAULT_FRAME_NR.
+ * @param[in] rate   Probability per transfer in 1/65536, 0 turns the fault off.
+ */
+void ifx_i2c_fault_set_rate(uint8_t fault, uint16_t rate);
+
+/**
+ * @brief Function for reading the number of injected faults.
+ *
+ * @param[out] counts  IFX_I2C_FAULT_COUNT counters, indexed by fault class.
+ * @param[in]  reset   If 1, the counters are cleared after reading.
+ */
+void ifx_i2c_fault_get_counts(uint16_t* counts, uint8_t reset);
+
+/**
+ * @brief Function called by the HAL before a write.
+ *
+ * @param[in] data    Data to write, the first byte is the register address.
+ * @param[in] length  Length of the data.
+ *
+ * @retval  IFX_I2C_FAULT_PASS, IFX_I2C_FAULT_FAIL or IFX_I2C_FAULT_SKIP.
+ */
+uint8_t ifx_i2c_fault_transmit(const uint8_t* data, uint16_t length);
+
+/**
+ * @brief Function called by the HAL after a read, it may change the data or the number of bytes read.
+ *
+ * @param[in,out] data    Data read from the register addressed by the last write.
+ * @param[in,out] length  Number of bytes read.
+ */
+void ifx_i2c_fault_receive(uint8_t* data, uint16_t* length);
+
+#endif /* IFX_I2C_FAULT_INJECTION */
+
+#endif /* IFX_I2C_FAULT_H__ */
+
+/**
+ * @}
+ **/
@@ -37,6 +37,12 @@
  * @ingroup ifx_i2c
  *
  * @brief Module for the data link layer of the Infineon I2C Protocol Stack library.
+ *
+ * The transfer and timer functions are split-phase: they start an operation and may return before it
+ * is complete. Completion is reported later with ifx_i2c_event_post() or ifx_i2c_event_post_timer(),
+ * which may be called from an interrupt, a DMA callback or ifx_i2c_hal_poll(). The protocol layers
+ * start at most one transfer or timer at a time and only continue once its completion is dispatched.
+ * The buffer passed to a transfer stays valid until then.
  */
 
 #ifndef IFX_I2C_HAL_H__
@@ -58,13 +64,6 @@
  */
 typedef void (*IFX_I2C_EventHandler)(uint8_t event);
 
-/**
- * @brief Function to perform a software reset on optiga.
- *
- * @param  void
- */
-uint16_t ifx_i2c_optiga_soft_reset(void);
-
 /**
  * @brief Function for initializing a HAL module.
  *
@@ -77,9 +76,11 @@ uint16_t ifx_i2c_optiga_soft_reset(void);
 uint16_t ifx_i2c_init(uint8_t reinit, IFX_I2C_EventHandler handler);
 
 /**
- * @brief I2C transmit function to conduct an I2 write on I2C bus.
+ * @brief I2C transmit function to start an I2C write on I2C bus.
  *
- * The function conducts an I2C write on the I2C bus.
+ * The function starts an I2C write on the I2C bus and may return before it is complete. The result
+ * (IFX_I2C_HAL_TX_SUCCESS or IFX_I2C_HAL_ERROR) is posted with ifx_i2c_event_post() instead of
+ * calling the event handler directly.
  *
  * @param  data    Pointer to buffer with data to be written to I2C slave
  * @param  length  Length of data in data buffer
@@ -87,15 +88,24 @@ uint16_t ifx_i2c_init(uint8_t reinit, IFX_I2C_EventHandler handler);
 void ifx_i2c_transmit(uint8_t* data, uint16_t length);
 
 /**
- * @brief I2C receive function to conduct an I2 read on I2C bus.
+ * @brief I2C receive function to start an I2C read on I2C bus.
  *
- * The function conducts an I2C read on the I2C bus.
+ * The function starts an I2C read on the I2C bus and may return before it is complete. The result
+ * (IFX_I2C_HAL_RX_SUCCESS or IFX_I2C_HAL_ERROR) is posted with ifx_i2c_event_post() instead of
+ * calling the event handler directly.
  *
  * @param  data    Pointer to buffer where received data shall be stored
  * @param  length  Number of bytes to read from I2C slave
  */
 void ifx_i2c_receive(uint8_t* data, uint16_t length);
 
+/**
+ * @brief Function returning the largest number of bytes of a single I2C read or write.
+ *
+ * The physical layer limits the frame size to fit the register address and a frame into one write.
+ */
+uint16_t ifx_i2c_max_transfer(void);
+
 /**
  * @brief Callback function to handle elapsed timer.
  */
@@ -104,14 +114,40 @@ typedef void (*IFX_Timer_Callback)(void);
 /**
  * @brief Timer setup function to initialize and start a timer.
  *
- * The function initializes and starts a timer that will call callback_function
- * after time_ms milliseconds have elapsed.
+ * The function initializes and starts a timer and returns immediately. Once time_us microseconds
+ * have elapsed, callback_function is posted with ifx_i2c_event_post_timer().
  *
  * @param  time_us            Time in microseconds after the timer expires
  * @param  callback_function  Function to be called once timer expired
  */
 void ifx_timer_setup(uint16_t time_us, IFX_Timer_Callback callback_function);
 
+/**
+ * @brief Function to progress a started transfer or timer.
+ *
+ * Called by ifx_i2c_event_dispatch() while no event is pending. A HAL without interrupts performs
+ * the transfer or checks the timer here and posts the completion. A HAL that completes operations
+ * from interrupts implements it as an empty function.
+ */
+void ifx_i2c_hal_poll(void);
+
+/**
+ * @brief Function returning how long the stack does not need the I2C bus.
+ *
+ * While no transfer is started and a timer is running (e.g. between two polls of the I2C_STATE register),
+ * the bus is released until the timer expires. Other devices on the same bus can use it in this window.
+ *
+ * @retval  Microseconds until the running timer expires, 0 if the stack needs the bus or no timer is running
+ */
+uint16_t ifx_i2c_hal_idle_us(void);
+
+/**
+ * @brief Function returning the time the HAL occupied the I2C bus.
+ *
+ * @retval  Microseconds spent in I2C transfers since the start, wraps around
+ */
+uint32_t ifx_i2c_hal_bus_us(void);
+
 
 #if IFX_I2C_LOG_PL == 1 || IFX_I2C_LOG_DL == 1 || IFX_I2C_LOG_TL == 1 || IFX_I2C_LOG_HAL == 1
 
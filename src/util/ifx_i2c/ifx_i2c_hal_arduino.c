@@ -6,91 +6,37 @@
  */
 
 
-#ifdef ARDUINO
+#include "ifx_i2c_config.h"
+
+#if defined(ARDUINO) && !IFX_I2C_HAL_REPLAY && !IFX_I2C_HAL_LINUX
 
 #include "ifx_i2c_hal.h"
+#include "ifx_i2c_event.h"
+#include "ifx_i2c_fault.h"
+#include "ifx_i2c_record.h"
 #include "../WireConnector/WireConnector.h"
 #include "Arduino.h"
 
 #define MAX_POLLING				50
 
-static volatile IFX_I2C_EventHandler upper_layer_event_handler = 0;
-volatile IFX_Timer_Callback timer_callback              = 0;
-
-//used in IFXOPTIGATrustE.cpp. Reduces the stack size because it is declared as an extern variable
-uint8_t m_timer_done = 0;
-
-/*
- * Used for the soft reset while initializing the handler.
- * Transmits data to the Slave
- */
-void ifx_i2c_transmitWithoutHandler(uint8_t* data, uint16_t length)
-{
-	uint8_t wReceivedBytes = 1;
-	uint16_t counterForTransmission = 0;
-	do
-	 {
-
-		Wire_beginTransmission(IFX_I2C_BASE_ADDR);
-		Wire_write(data, length);
-		wReceivedBytes = Wire_endTransmission((uint8_t)1);
-		counterForTransmission++;
-	 }  while (wReceivedBytes != 0 && counterForTransmission < MAX_POLLING);
-}
-
-/*
- * Used for the soft reset while initializing the handler.
- * Receives data from the Slave
- */
-bool ifx_i2c_receiveWithoutHandler(uint8_t* data, uint16_t length)
-{
-	uint8_t wReceivedBytes = 0;
-	uint16_t wReadLen = 0;
-	uint16_t counterForRecieve = 0;
-	do
-	{
-
-		Wire_beginTransmission(IFX_I2C_BASE_ADDR);
-		wReceivedBytes = Wire_requestFrom(IFX_I2C_BASE_ADDR, length, (uint8_t)1);
-		counterForRecieve++;
-	}	while(wReceivedBytes==0 && counterForRecieve < MAX_POLLING);
-
-
-	while(Wire_available())
-	{
-	   data[wReadLen] = Wire_read();
-	   wReadLen++;
-	}
-
-	if (wReadLen == length) return false;
-	else return true;
-}
-
-/**
- * @brief Function to perform a software reset on optiga.
- *
- * @param  void
- */
-uint16_t ifx_i2c_optiga_soft_reset(void)
-{
-	uint8_t rgbSoftResetData[3] = {0x88,0x00,0x00};
-	uint8_t prgbStateDataReg[4] = {0x00};
-	uint8_t prgbStateRegWrite[1] = { 0x82 };
-
-	//Check if the soft reset is supported
-	ifx_i2c_transmitWithoutHandler(prgbStateRegWrite,1);
+#define HAL_OP_NONE				0
+#define HAL_OP_TRANSMIT			1
+#define HAL_OP_RECEIVE			2
 
-	if (ifx_i2c_receiveWithoutHandler(prgbStateDataReg,4)) return IFX_I2C_STACK_ERROR;
+static volatile IFX_I2C_EventHandler upper_layer_event_handler = 0;
 
-	if(0x08 != (prgbStateDataReg[0]&0x08))
-	{
-		return IFX_I2C_STACK_ERROR;
-	}
+//Transfer started by the protocol stack, carried out by ifx_i2c_hal_poll
+static volatile uint8_t  m_op = HAL_OP_NONE;
+static uint8_t*          m_op_data;
+static uint16_t          m_op_length;
 
-	ifx_i2c_transmitWithoutHandler(rgbSoftResetData,3);
+//Timer started by the protocol stack, checked by ifx_i2c_hal_poll
+static volatile IFX_Timer_Callback m_timer_callback = 0;
+static unsigned long     m_timer_start;
+static uint16_t          m_timer_us;
 
-	return IFX_I2C_STACK_SUCCESS;
-}
+//Time spent in transfers by ifx_i2c_hal_poll
+static uint32_t          m_bus_us;
 
 /**
  * @brief Function for initializing a HAL module.
@@ -106,24 +52,50 @@ uint16_t ifx_i2c_init(uint8_t reinit, IFX_I2C_EventHandler handler)
 	if (reinit) {Wire_end();}
 
 	upper_layer_event_handler = handler;
+	m_op = HAL_OP_NONE;
+	m_timer_callback = 0;
+	ifx_i2c_event_init();
 
 	Wire_begin();
 
-	return ifx_i2c_optiga_soft_reset();
+	return IFX_I2C_STACK_SUCCESS;
 }
 
-/**
- * @brief I2C transmit function to conduct an I2 write on I2C bus.
- *
- * The function conducts an I2C write on the I2C bus.
- *
- * @param  data    Pointer to buffer with data to be written to I2C slave
- * @param  length  Length of data in data buffer
+/*
+ * Posts the result of a transfer to the upper layer handler (physical layer), the transfer is recorded first
  */
-void ifx_i2c_transmit(uint8_t* data, uint16_t length)
+static void ifx_i2c_transfer_post(uint8_t type, const uint8_t* data, uint16_t length, uint8_t event)
+{
+#if IFX_I2C_RECORD
+	ifx_i2c_record_transfer(type | (event == IFX_I2C_HAL_ERROR ? IFX_I2C_RECORD_ERROR : 0), data, length, micros());
+#else
+	(void)type;
+	(void)data;
+	(void)length;
+#endif
+	ifx_i2c_event_post(upper_layer_event_handler, event);
+}
+
+/*
+ * Conducts an I2C write on the I2C bus and posts the result
+ */
+static void ifx_i2c_transfer_transmit(uint8_t* data, uint16_t length)
 {
 	uint8_t wReceivedBytes = 1;
 	uint16_t counterForTransmission = 0;
+
+#if IFX_I2C_FAULT_INJECTION
+	switch (ifx_i2c_fault_transmit(data, length))
+	{
+		case IFX_I2C_FAULT_FAIL:
+			ifx_i2c_transfer_post(0, data, length, IFX_I2C_HAL_ERROR);
+			return;
+		case IFX_I2C_FAULT_SKIP:
+			ifx_i2c_transfer_post(0, data, length, IFX_I2C_HAL_TX_SUCCESS);
+			return;
+	}
+#endif
+
 	//According to the protocol of the Optiga Trust E, it might require some time to turn on and respond
 	do
 	 {
@@ -133,31 +105,27 @@ void ifx_i2c_transmit(uint8_t* data, uint16_t length)
 		counterForTransmission++;
 	 }  while (wReceivedBytes != 0 && counterForTransmission < MAX_POLLING);
 
-	//Go to the upper layer handler (physical layer)
+	//Queue the result for the upper layer handler (physical layer)
 	if (wReceivedBytes == 0)
 	{
-		upper_layer_event_handler(IFX_I2C_HAL_TX_SUCCESS);
+		ifx_i2c_transfer_post(0, data, length, IFX_I2C_HAL_TX_SUCCESS);
 	}
 	else
 	{
-		upper_layer_event_handler(IFX_I2C_HAL_ERROR);
+		ifx_i2c_transfer_post(0, data, length, IFX_I2C_HAL_ERROR);
 	}
 }
 
-/**
- * @brief I2C receive function to conduct an I2 read on I2C bus.
- *
- * The function conducts an I2C read on the I2C bus.
- *
- * @param  data    Pointer to buffer where received data shall be stored
- * @param  length  Number of bytes to read from I2C slave
+/*
+ * Conducts an I2C read on the I2C bus and posts the result
  */
-void ifx_i2c_receive(uint8_t* data, uint16_t length)
+static void ifx_i2c_transfer_receive(uint8_t* data, uint16_t length)
 {
 	uint16_t wReadLen = 0;
 
-	uint8_t wReceivedBytes = 0;
+	uint16_t wReceivedBytes = 0;
 	uint16_t counterForRecieve = 0;
+
 //According to the protocol of the Optiga Trust E, it might require some time to turn on and respond
 	do
 	{
@@ -168,7 +136,7 @@ void ifx_i2c_receive(uint8_t* data, uint16_t length)
 
 	if (wReceivedBytes == 0)
 	{
-		upper_layer_event_handler(IFX_I2C_HAL_ERROR);
+		ifx_i2c_transfer_post(IFX_I2C_RECORD_READ, data, 0, IFX_I2C_HAL_ERROR);
 	}
 
 	else
@@ -178,16 +146,19 @@ void ifx_i2c_receive(uint8_t* data, uint16_t length)
 		   data[wReadLen] = Wire_read();
 		   wReadLen++;
 		}
+#if IFX_I2C_FAULT_INJECTION
+		ifx_i2c_fault_receive(data, &wReadLen);
+#endif
 
-		//Go to the upper layer handler (physical layer). We have received the bytes that we needed
+		//Queue the result for the upper layer handler (physical layer). We have received the bytes that we needed
 		if (wReadLen == length)
 		{
-			upper_layer_event_handler(IFX_I2C_HAL_RX_SUCCESS);
+			ifx_i2c_transfer_post(IFX_I2C_RECORD_READ, data, wReadLen, IFX_I2C_HAL_RX_SUCCESS);
 		}
 
 		else
 		{
-			upper_layer_event_handler(IFX_I2C_HAL_ERROR);
+			ifx_i2c_transfer_post(IFX_I2C_RECORD_READ, data, wReadLen, IFX_I2C_HAL_ERROR);
 		}
 	}
 
@@ -195,11 +166,54 @@ void ifx_i2c_receive(uint8_t* data, uint16_t length)
 
 }
 
+/**
+ * @brief I2C transmit function to start an I2C write on I2C bus.
+ *
+ * The function only records the transfer, it is carried out by ifx_i2c_hal_poll.
+ *
+ * @param  data    Pointer to buffer with data to be written to I2C slave
+ * @param  length  Length of data in data buffer
+ */
+void ifx_i2c_transmit(uint8_t* data, uint16_t length)
+{
+	ifx_i2c_event_mark_stack();
+
+	m_op_data = data;
+	m_op_length = length;
+	m_op = HAL_OP_TRANSMIT;
+}
+
+/**
+ * @brief I2C receive function to start an I2C read on I2C bus.
+ *
+ * The function only records the transfer, it is carried out by ifx_i2c_hal_poll.
+ *
+ * @param  data    Pointer to buffer where received data shall be stored
+ * @param  length  Number of bytes to read from I2C slave
+ */
+void ifx_i2c_receive(uint8_t* data, uint16_t length)
+{
+	ifx_i2c_event_mark_stack();
+
+	m_op_data = data;
+	m_op_length = length;
+	m_op = HAL_OP_RECEIVE;
+}
+
+/**
+ * @brief Function returning the largest number of bytes of a single I2C read or write.
+ *
+ * This is the buffer size of the Wire library detected at compile time.
+ */
+uint16_t ifx_i2c_max_transfer(void)
+{
+	return Wire_bufferLength();
+}
+
 /**
  * @brief Timer setup function to initialize and start a timer.
  *
- * The function delays for the time given. Then it changes the value of m_time_done, which is an extern variable used in IFXOPTIGATrustE.cpp.
- * Since this function is not recursive, it reduces the size of the stack each time it is called.
+ * The function records the start time and returns. ifx_i2c_hal_poll queues the callback once the time has elapsed.
  *
  * @param  time_us            Time in microseconds after the timer expires
  * @param  callback_function  Function to be called once timer expired
@@ -207,12 +221,70 @@ void ifx_i2c_receive(uint8_t* data, uint16_t length)
 
 void ifx_timer_setup(uint16_t time_us, IFX_Timer_Callback callback_function)
 {
-	timer_callback = callback_function;
+	ifx_i2c_event_mark_stack();
+
+	m_timer_start = micros();
+	m_timer_us = time_us;
+	m_timer_callback = callback_function;
+}
+
+/**
+ * @brief Function to progress a started transfer or timer.
+ *
+ * Wire transfers are blocking, so the transfer started last is carried out here and its result is posted.
+ * An expired timer is posted as well. Interrupt driven ports post from their interrupt handlers instead.
+ */
+void ifx_i2c_hal_poll(void)
+{
+	IFX_Timer_Callback callback;
+	unsigned long start;
+	uint8_t op = m_op;
+
+	if (op != HAL_OP_NONE)
+	{
+		m_op = HAL_OP_NONE;
+		start = micros();
+		if (op == HAL_OP_TRANSMIT)
+		{
+			ifx_i2c_transfer_transmit(m_op_data, m_op_length);
+		}
+		else
+		{
+			ifx_i2c_transfer_receive(m_op_data, m_op_length);
+		}
+		m_bus_us += micros() - start;
+	}
+	else if (m_timer_callback && (unsigned long)(micros() - m_timer_start) >= m_timer_us)
+	{
+		callback = m_timer_callback;
+		m_timer_callback = 0;
+		ifx_i2c_event_post_timer(callback);
+	}
+}
 
-	delayMicroseconds(time_us);
+/**
+ * @brief Function returning how long the stack does not need the I2C bus.
+ *
+ * The Wire is only used by ifx_i2c_hal_poll, so the bus is free while only a timer is running.
+ */
+uint16_t ifx_i2c_hal_idle_us(void)
+{
+	unsigned long elapsed;
 
-	m_timer_done = 1;
+	if (m_op != HAL_OP_NONE || !m_timer_callback)
+	{
+		return 0;
+	}
+	elapsed = micros() - m_timer_start;
+	return (elapsed < m_timer_us) ? m_timer_us - elapsed : 0;
+}
 
+/**
+ * @brief Function returning the time the HAL occupied the I2C bus.
+ */
+uint32_t ifx_i2c_hal_bus_us(void)
+{
+	return m_bus_us;
 }
 
 #endif
@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// IFX I2C Protocol Stack - Linux HAL (source file)
+//
+// Reference for a HAL that completes its operations asynchronously. ifx_i2c_transmit(), ifx_i2c_receive() and
+// ifx_timer_setup() hand the operation to a worker thread and return. The worker carries it out on the i2c-dev
+// bus and posts the completion from its own context, like the interrupt handler of a microcontroller port.
+// The protocol layers only run in the thread calling ifx_i2c_event_dispatch().
+
+#include "ifx_i2c_config.h"
+
+#if IFX_I2C_HAL_LINUX
+
+#include "ifx_i2c_hal.h"
+#include "ifx_i2c_event.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+// The device does not acknowledge its address while it is busy or wakes up
+#define MAX_POLLING             50
+// Pause between two attempts, a failed transfer may return without occupying the bus
+#define HAL_RETRY_INTERVAL_US   1000
+// Largest transfer of the i2c-dev driver
+#define HAL_MAX_TRANSFER        8192
+
+#define HAL_OP_NONE             0
+#define HAL_OP_TRANSMIT         1
+#define HAL_OP_RECEIVE          2
+#define HAL_OP_TIMER            3
+
+static IFX_I2C_EventHandler upper_layer_event_handler = 0;
+
+static int              m_fd = -1;
+static pthread_t        m_worker;
+static uint8_t          m_worker_started;
+static pthread_once_t   m_once = PTHREAD_ONCE_INIT;
+
+// Operation handed to the worker, all guarded by m_lock. m_session changes with every ifx_i2c_init, so the
+// completion of an operation of an earlier session is not posted. m_wakeup measures the timer deadline on
+// CLOCK_MONOTONIC, so setting the system time does not shift a running timer.
+static pthread_mutex_t  m_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   m_wakeup;
+static pthread_cond_t   m_idle = PTHREAD_COND_INITIALIZER;
+static uint8_t          m_op = HAL_OP_NONE;
+static uint8_t          m_busy;
+static uint32_t         m_session;
+static uint8_t*         m_op_data;
+static uint16_t         m_op_length;
+static IFX_Timer_Callback m_timer_callback;
+static struct timespec  m_timer_deadline;
+
+// Time spent in transfers
+static uint32_t         m_bus_us;
+
+static uint32_t ifx_i2c_hal_elapsed_us(const struct timespec* start, const struct timespec* end)
+{
+    return (uint32_t)((end->tv_sec - start->tv_sec) * 1000000L + (end->tv_nsec - start->tv_nsec) / 1000);
+}
+
+// Writes to the device, repeated while the device does not acknowledge
+static uint8_t ifx_i2c_hal_write(const uint8_t* data, uint16_t length)
+{
+    uint16_t counter = 0;
+
+    while (write(m_fd, data, length) != (ssize_t)length)
+    {
+        if (++counter >= MAX_POLLING)
+        {
+            return 0;
+        }
+        usleep(HAL_RETRY_INTERVAL_US);
+    }
+    return 1;
+}
+
+// Reads from the device, repeated while the device does not acknowledge
+static uint8_t ifx_i2c_hal_read(uint8_t* data, uint16_t length)
+{
+    uint16_t counter = 0;
+
+    while (read(m_fd, data, length) != (ssize_t)length)
+    {
+        if (++counter >= MAX_POLLING)
+        {
+            return 0;
+        }
+        usleep(HAL_RETRY_INTERVAL_US);
+    }
+    return 1;
+}
+
+// Creates m_wakeup with the clock of the timer deadlines
+static void ifx_i2c_hal_init_once(void)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&m_wakeup, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+// Carries out the operations handed over by the protocol stack and posts their completion
+static void* ifx_i2c_hal_worker(void* argument)
+{
+    struct timespec start;
+    struct timespec end;
+    uint8_t* data;
+    uint16_t length;
+    uint32_t session;
+    uint8_t  op;
+    uint8_t  success;
+    IFX_Timer_Callback callback;
+
+    (void)argument;
+    pthread_mutex_lock(&m_lock);
+    for (;;)
+    {
+        while (m_op == HAL_OP_NONE)
+        {
+            pthread_cond_wait(&m_wakeup, &m_lock);
+        }
+        op = m_op;
+        session = m_session;
+
+        if (op == HAL_OP_TIMER)
+        {
+            // Woken up early if the HAL is initialized again meanwhile
+            while (m_op == HAL_OP_TIMER && m_session == session
+                   && pthread_cond_timedwait(&m_wakeup, &m_lock, &m_timer_deadline) != ETIMEDOUT)
+            {
+            }
+            if (m_op == HAL_OP_TIMER && m_session == session)
+            {
+                m_op = HAL_OP_NONE;
+                callback = m_timer_callback;
+                ifx_i2c_event_post_timer(callback);
+            }
+            continue;
+        }
+
+        // The transfer runs without the lock, ifx_i2c_init waits for it
+        data = m_op_data;
+        length = m_op_length;
+        m_op = HAL_OP_NONE;
+        m_busy = 1;
+        pthread_mutex_unlock(&m_lock);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (op == HAL_OP_TRANSMIT)
+        {
+            success = ifx_i2c_hal_write(data, length);
+        }
+        else
+        {
+            success = ifx_i2c_hal_read(data, length);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        pthread_mutex_lock(&m_lock);
+        m_bus_us += ifx_i2c_hal_elapsed_us(&start, &end);
+        m_busy = 0;
+        pthread_cond_broadcast(&m_idle);
+        if (m_session == session)
+        {
+            ifx_i2c_event_post(upper_layer_event_handler, !success ? IFX_I2C_HAL_ERROR
+                               : (op == HAL_OP_TRANSMIT) ? IFX_I2C_HAL_TX_SUCCESS : IFX_I2C_HAL_RX_SUCCESS);
+        }
+    }
+    return NULL;
+}
+
+// Hands an operation to the worker
+static void ifx_i2c_hal_start(uint8_t op, uint8_t* data, uint16_t length)
+{
+    pthread_mutex_lock(&m_lock);
+    m_op_data = data;
+    m_op_length = length;
+    m_op = op;
+    pthread_cond_broadcast(&m_wakeup);
+    pthread_mutex_unlock(&m_lock);
+}
+
+/**
+ * @brief Function for initializing a HAL module.
+ *
+ * Opens IFX_I2C_HAL_LINUX_DEVICE and starts the worker the first time. An operation still running
+ * is completed first, its completion is not posted.
+ *
+ * @param  reinit   If 1, the call shal re-initializes the HAL module if it was used before.
+ *                  If 0, the module is initialized for the first time.
+ * @param  handler  Event handler to propagate events to the upper layer
+ */
+uint16_t ifx_i2c_init(uint8_t reinit, IFX_I2C_EventHandler handler)
+{
+    (void)reinit;
+
+    pthread_once(&m_once, ifx_i2c_hal_init_once);
+    pthread_mutex_lock(&m_lock);
+    m_session++;
+    m_op = HAL_OP_NONE;
+    pthread_cond_broadcast(&m_wakeup);
+    while (m_busy)
+    {
+        pthread_cond_wait(&m_idle, &m_lock);
+    }
+    upper_layer_event_handler = handler;
+    ifx_i2c_event_init();
+    pthread_mutex_unlock(&m_lock);
+
+    if (m_fd < 0)
+    {
+        m_fd = open(IFX_I2C_HAL_LINUX_DEVICE, O_RDWR);
+        if (m_fd < 0 || ioctl(m_fd, I2C_SLAVE, IFX_I2C_BASE_ADDR) < 0)
+        {
+            if (m_fd >= 0)
+            {
+                close(m_fd);
+                m_fd = -1;
+            }
+            return IFX_I2C_STACK_ERROR;
+        }
+    }
+    if (!m_worker_started)
+    {
+        if (pthread_create(&m_worker, NULL, ifx_i2c_hal_worker, NULL) != 0)
+        {
+            return IFX_I2C_STACK_ERROR;
+        }
+        m_worker_started = 1;
+    }
+
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+/**
+ * @brief I2C transmit function to start an I2C write on I2C bus.
+ *
+ * The write is carried out by the worker, which posts the result.
+ *
+ * @param  data    Pointer to buffer with data to be written to I2C slave
+ * @param  length  Length of data in data buffer
+ */
+void ifx_i2c_transmit(uint8_t* data, uint16_t length)
+{
+    ifx_i2c_event_mark_stack();
+    ifx_i2c_hal_start(HAL_OP_TRANSMIT, data, length);
+}
+
+/**
+ * @brief I2C receive function to start an I2C read on I2C bus.
+ *
+ * The read is carried out by the worker, which posts the result.
+ *
+ * @param  data    Pointer to buffer where received data shall be stored
+ * @param  length  Number of bytes to read from I2C slave
+ */
+void ifx_i2c_receive(uint8_t* data, uint16_t length)
+{
+    ifx_i2c_event_mark_stack();
+    ifx_i2c_hal_start(HAL_OP_RECEIVE, data, length);
+}
+
+/**
+ * @brief Function returning the largest number of bytes of a single I2C read or write.
+ */
+uint16_t ifx_i2c_max_transfer(void)
+{
+    return HAL_MAX_TRANSFER;
+}
+
+/**
+ * @brief Timer setup function to initialize and start a timer.
+ *
+ * The worker waits until the time has elapsed and posts the callback.
+ *
+ * @param  time_us            Time in microseconds after the timer expires
+ * @param  callback_function  Function to be called once timer expired
+ */
+void ifx_timer_setup(uint16_t time_us, IFX_Timer_Callback callback_function)
+{
+    struct timespec deadline;
+
+    ifx_i2c_event_mark_stack();
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_nsec += (long)time_us * 1000;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&m_lock);
+    m_timer_deadline = deadline;
+    m_timer_callback = callback_function;
+    pthread_mutex_unlock(&m_lock);
+    ifx_i2c_hal_start(HAL_OP_TIMER, NULL, 0);
+}
+
+/**
+ * @brief Function to progress a started transfer or timer.
+ *
+ * The worker completes the operations, the dispatch loop only gives it the processor.
+ */
+void ifx_i2c_hal_poll(void)
+{
+    sched_yield();
+}
+
+/**
+ * @brief Function returning how long the stack does not need the I2C bus.
+ */
+uint16_t ifx_i2c_hal_idle_us(void)
+{
+    struct timespec now;
+    uint32_t idle = 0;
+
+    pthread_mutex_lock(&m_lock);
+    if (m_op == HAL_OP_TIMER)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec < m_timer_deadline.tv_sec
+            || (now.tv_sec == m_timer_deadline.tv_sec && now.tv_nsec < m_timer_deadline.tv_nsec))
+        {
+            idle = ifx_i2c_hal_elapsed_us(&now, &m_timer_deadline);
+        }
+    }
+    pthread_mutex_unlock(&m_lock);
+
+    return (idle > 0xFFFF) ? 0xFFFF : (uint16_t)idle;
+}
+
+/**
+ * @brief Function returning the time the HAL occupied the I2C bus.
+ */
+uint32_t ifx_i2c_hal_bus_us(void)
+{
+    uint32_t bus_us;
+
+    pthread_mutex_lock(&m_lock);
+    bus_us = m_bus_us;
+    pthread_mutex_unlock(&m_lock);
+
+    return bus_us;
+}
+
+#endif /* IFX_I2C_HAL_LINUX */
@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// IFX I2C Protocol Stack - Replay HAL (source file)
+
+#include "ifx_i2c_record.h"
+
+#if IFX_I2C_HAL_REPLAY
+
+#include "ifx_i2c_hal.h"
+#include "ifx_i2c_event.h"
+#include <string.h> // memcmp, memcpy, memset
+
+#define HAL_OP_NONE             0
+#define HAL_OP_TRANSMIT         1
+#define HAL_OP_RECEIVE          2
+
+// Recorded transaction
+typedef struct
+{
+    uint8_t        type;
+    uint32_t       gap_us;
+    const uint8_t* data;
+    uint16_t       length;
+} ifx_i2c_replay_record_t;
+
+static IFX_I2C_EventHandler upper_layer_event_handler = 0;
+
+// Log and read position
+static const uint8_t*   m_log;
+static uint32_t         m_log_len;
+static uint32_t         m_pos;
+static uint16_t         m_max_transfer;
+
+// Transfer and timer started by the protocol stack, completed by ifx_i2c_hal_poll
+static uint8_t          m_op = HAL_OP_NONE;
+static uint8_t*         m_op_data;
+static uint16_t         m_op_length;
+static IFX_Timer_Callback m_timer_callback = 0;
+
+static ifx_i2c_replay_stats_t m_stats;
+
+// Reads a varint at the read position, returns 0 if the log ends or the value is too large
+static uint8_t ifx_i2c_replay_varint(uint32_t* value)
+{
+    uint8_t shift = 0;
+    uint8_t byte;
+
+    *value = 0;
+    do
+    {
+        if (m_pos >= m_log_len || shift > 28)
+        {
+            return 0;
+        }
+        byte = m_log[m_pos++];
+        *value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return 1;
+}
+
+// Reads the next record without consuming it, returns 0 at the end of the log
+static uint8_t ifx_i2c_replay_peek(ifx_i2c_replay_record_t* record, uint32_t* next)
+{
+    uint32_t pos = m_pos;
+    uint32_t length;
+    uint8_t  valid = 0;
+
+    if (m_pos < m_log_len)
+    {
+        record->type = m_log[m_pos++];
+        if (ifx_i2c_replay_varint(&record->gap_us) && ifx_i2c_replay_varint(&length)
+            && length <= 0xFFFF && length <= m_log_len - m_pos)
+        {
+            record->data = m_log + m_pos;
+            record->length = (uint16_t)length;
+            *next = m_pos + length;
+            valid = 1;
+        }
+    }
+    m_pos = pos;
+    return valid;
+}
+
+// Counts a transaction of the stack that differs from the log
+static void ifx_i2c_replay_mismatch(void)
+{
+    m_stats.mismatches++;
+    if (m_stats.first_mismatch == 0)
+    {
+        m_stats.first_mismatch = m_stats.transactions + 1;
+    }
+}
+
+// Consumes the next record if it has the expected direction, returns 0 otherwise
+static uint8_t ifx_i2c_replay_next(uint8_t type, ifx_i2c_replay_record_t* record)
+{
+    uint32_t next;
+
+    if (!ifx_i2c_replay_peek(record, &next)
+        || (record->type & IFX_I2C_RECORD_READ) != type)
+    {
+        ifx_i2c_replay_mismatch();
+        return 0;
+    }
+    m_pos = next;
+    m_stats.transactions++;
+    m_stats.recorded_us += record->gap_us;
+    return 1;
+}
+
+/*
+ * Replays a write, returns 0 if it succeeded on the recording host
+ */
+static uint8_t ifx_i2c_replay_write(uint8_t type, const uint8_t* data, uint16_t length)
+{
+    ifx_i2c_replay_record_t record;
+
+    if (!ifx_i2c_replay_next(type, &record))
+    {
+        return 1;
+    }
+    if (record.length != length || memcmp(record.data, data, length) != 0)
+    {
+        ifx_i2c_replay_mismatch();
+    }
+    return (record.type & IFX_I2C_RECORD_ERROR) ? 1 : 0;
+}
+
+/*
+ * Replays a read with the recorded data, returns 0 if it succeeded on the recording host
+ */
+static uint8_t ifx_i2c_replay_read(uint8_t type, uint8_t* data, uint16_t length)
+{
+    ifx_i2c_replay_record_t record;
+
+    if (!ifx_i2c_replay_next(type | IFX_I2C_RECORD_READ, &record))
+    {
+        return 1;
+    }
+    if (record.length > length || (record.length < length && !(record.type & IFX_I2C_RECORD_ERROR)))
+    {
+        ifx_i2c_replay_mismatch();
+        return 1;
+    }
+    memcpy(data, record.data, record.length);
+    return (record.type & IFX_I2C_RECORD_ERROR) ? 1 : 0;
+}
+
+uint16_t ifx_i2c_replay_start(const uint8_t* log, uint32_t length)
+{
+    m_log = 0;
+    m_log_len = 0;
+    m_pos = 0;
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    if (!log || length < IFX_I2C_RECORD_HEADER_LEN || memcmp(log, IFX_I2C_RECORD_MAGIC, 4) != 0
+        || log[4] != IFX_I2C_RECORD_VERSION)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+
+    m_log = log;
+    m_log_len = length;
+    m_pos = IFX_I2C_RECORD_HEADER_LEN;
+    m_max_transfer = log[5] | (log[6] << 8);
+    return IFX_I2C_STACK_SUCCESS;
+}
+
+void ifx_i2c_replay_get_stats(ifx_i2c_replay_stats_t* stats)
+{
+    *stats = m_stats;
+    stats->remaining = m_log_len - m_pos;
+}
+
+/**
+ * @brief Function for initializing a HAL module.
+ *
+ * The log has to be set with ifx_i2c_replay_start() before.
+ *
+ * @param  reinit   If 1, the call shal re-initializes the HAL module if it was used before.
+ *                  If 0, the module is initialized for the first time.
+ * @param  handler  Event handler to propagate events to the upper layer
+ */
+uint16_t ifx_i2c_init(uint8_t reinit, IFX_I2C_EventHandler handler)
+{
+    (void)reinit;
+    upper_layer_event_handler = handler;
+    m_op = HAL_OP_NONE;
+    m_timer_callback = 0;
+    ifx_i2c_event_init();
+
+    return m_log ? IFX_I2C_STACK_SUCCESS : IFX_I2C_STACK_ERROR;
+}
+
+/**
+ * @brief I2C transmit function to start an I2C write on I2C bus.
+ *
+ * The function only records the transfer, it is replayed by ifx_i2c_hal_poll.
+ *
+ * @param  data    Pointer to buffer with data to be written to I2C slave
+ * @param  length  Length of data in data buffer
+ */
+void ifx_i2c_transmit(uint8_t* data, uint16_t length)
+{
+    ifx_i2c_event_mark_stack();
+
+    m_op_data = data;
+    m_op_length = length;
+    m_op = HAL_OP_TRANSMIT;
+}
+
+/**
+ * @brief I2C receive function to start an I2C read on I2C bus.
+ *
+ * The function only records the transfer, it is replayed by ifx_i2c_hal_poll.
+ *
+ * @param  data    Pointer to buffer where received data shall be stored
+ * @param  length  Number of bytes to read from I2C slave
+ */
+void ifx_i2c_receive(uint8_t* data, uint16_t length)
+{
+    ifx_i2c_event_mark_stack();
+
+    m_op_data = data;
+    m_op_length = length;
+    m_op = HAL_OP_RECEIVE;
+}
+
+/**
+ * @brief Function returning the largest number of bytes of a single I2C read or write.
+ *
+ * This is the value of the recording host, so the stack negotiates the same frame size.
+ */
+uint16_t ifx_i2c_max_transfer(void)
+{
+    return m_max_transfer;
+}
+
+/**
+ * @brief Timer setup function to initialize and start a timer.
+ *
+ * The time of the recording host is part of the log, so the timer expires with the next ifx_i2c_hal_poll.
+ *
+ * @param  time_us            Time in microseconds after the timer expires
+ * @param  callback_function  Function to be called once timer expired
+ */
+void ifx_timer_setup(uint16_t time_us, IFX_Timer_Callback callback_function)
+{
+    (void)time_us;
+    ifx_i2c_event_mark_stack();
+
+    m_timer_callback = callback_function;
+}
+
+/**
+ * @brief Function to progress a started transfer or timer.
+ *
+ * The transfer started last is replayed from the log and its result is posted, a started timer is posted as expired.
+ */
+void ifx_i2c_hal_poll(void)
+{
+    IFX_Timer_Callback callback;
+    uint8_t op = m_op;
+
+    if (op != HAL_OP_NONE)
+    {
+        m_op = HAL_OP_NONE;
+        if (op == HAL_OP_TRANSMIT)
+        {
+            ifx_i2c_event_post(upper_layer_event_handler,
+                               ifx_i2c_replay_write(0, m_op_data, m_op_length) ? IFX_I2C_HAL_ERROR : IFX_I2C_HAL_TX_SUCCESS);
+        }
+        else
+        {
+            ifx_i2c_event_post(upper_layer_event_handler,
+                               ifx_i2c_replay_read(0, m_op_data, m_op_length) ? IFX_I2C_HAL_ERROR : IFX_I2C_HAL_RX_SUCCESS);
+        }
+    }
+    else if (m_timer_callback)
+    {
+        callback = m_timer_callback;
+        m_timer_callback = 0;
+        ifx_i2c_event_post_timer(callback);
+    }
+}
+
+/**
+ * @brief Function returning how long the stack does not need the I2C bus.
+ *
+ * Timers expire with the next poll, the replay has no idle time.
+ */
+uint16_t ifx_i2c_hal_idle_us(void)
+{
+    return 0;
+}
+
+/**
+ * @brief Function returning the time the HAL occupied the I2C bus.
+ *
+ * The replay does not use a bus.
+ */
+uint32_t ifx_i2c_hal_bus_us(void)
+{
+    return 0;
+}
+
+#endif /* IFX_I2C_HAL_REPLAY */
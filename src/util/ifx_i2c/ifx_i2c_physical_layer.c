@@ -35,6 +35,7 @@
 
 #include "ifx_i2c_physical_layer.h"
 #include "ifx_i2c_hal.h"
+#include "ifx_i2c_record.h"
 #include <string.h> // functions memcpy, memset
 
 // Setup debug log statements
@@ -49,11 +50,13 @@
 #define PL_REG_DATA                     0x80
 #define PL_REG_DATA_REG_LEN             0x81
 #define PL_REG_I2C_STATE                0x82
+#define PL_REG_SOFT_RESET               0x88
 
 // Physical Layer Register lengths
 #define PL_REG_I2C_STATE_LEN            4
 
 // Physical Layer State Register masks
+#define PL_REG_I2C_STATE_SOFT_RESET     0x08
 #define PL_REG_I2C_STATE_RESPONSE_READY 0x40
 #define PL_REG_I2C_STATE_STATUS_BUSY    0x80
 
@@ -63,8 +66,8 @@
 #define PL_I2C_CMD_WRITE                0x01
 #define PL_I2C_CMD_READ                 0x02
 
-// Physical Layer low level interface variables
-static          uint8_t m_buffer[DL_MAX_FRAME_SIZE];
+// Physical Layer low level interface variables (register address followed by content)
+static          uint8_t m_buffer[1 + DL_MAX_FRAME_SIZE];
 static volatile uint16_t m_buffer_tx_len;
 static volatile uint16_t m_buffer_rx_len;
 static volatile uint8_t  m_register_action;
@@ -79,6 +82,9 @@ static volatile uint16_t m_retry_counter;
 #define PL_STATE_READY                  0x02
 #define PL_STATE_POLL_STATUS            0x03
 #define PL_STATE_RXTX                   0x04
+#define PL_STATE_SOFT_RESET             0x05
+#define PL_STATE_SOFT_RESET_CHECK       0x06
+#define PL_STATE_SOFT_RESET_WRITE       0x07
 
 // Physical Layer high level interface variables
 static volatile uint8_t   m_frame_action;
@@ -86,6 +92,10 @@ static volatile uint8_t   m_frame_state = PL_STATE_UNINIT;
 static volatile uint8_t   m_status_polling_counter;
 static volatile uint8_t * m_tx_frame;
 static volatile uint16_t  m_tx_frame_len;
+static volatile uint16_t  m_frame_size = DL_MAX_FRAME_SIZE;
+static volatile uint8_t   m_negotiated;
+static volatile uint8_t   m_reset;
+static          uint8_t   m_soft_reset[sizeof(uint16_t)] = { 0x00, 0x00 };
 static volatile uint8_t   m_max_frame_size[sizeof(uint16_t)] = { DL_MAX_FRAME_SIZE >> 8, DL_MAX_FRAME_SIZE };
 static volatile ifx_i2c_event_handler_t m_upper_layer_event_handler;
 
@@ -130,6 +140,16 @@ static void ifx_i2c_pl_status_poll_callback(void)
     ifx_i2c_pl_read_register(PL_REG_I2C_STATE, PL_REG_I2C_STATE_LEN);
 }
 
+// Physical Layer high level interface function, marks the transfers of the soft reset in a recording
+static void ifx_i2c_pl_record_reset(uint8_t active)
+{
+#if IFX_I2C_RECORD
+    ifx_i2c_record_reset(active);
+#else
+    (void)active;
+#endif
+}
+
 // Physical Layer high level interface state machine (read/write frames)
 static void ifx_i2c_pl_frame_event_handler(uint8_t event)
 {
@@ -137,8 +157,39 @@ static void ifx_i2c_pl_frame_event_handler(uint8_t event)
 
     if (event == IFX_I2C_PL_EVENT_ERROR)
     {
-        // I2C read or write failed, report to upper layer
+        // I2C read or write failed, report to upper layer (which may start the next frame right away)
+        // The soft reset and the frame size are repeated with the next frame until the device has received them
+        ifx_i2c_pl_record_reset(0);
+        m_frame_state = !m_reset ? PL_STATE_SOFT_RESET : m_negotiated ? PL_STATE_READY : PL_STATE_INIT;
         m_upper_layer_event_handler(IFX_I2C_PL_EVENT_ERROR, 0, 0);
+        return;
+    }
+
+    // Soft reset of the device before the first frame, if the device supports it
+    if (m_frame_state == PL_STATE_SOFT_RESET)
+    {
+        ifx_i2c_pl_record_reset(1);
+        m_frame_state = PL_STATE_SOFT_RESET_CHECK;
+        ifx_i2c_pl_read_register(PL_REG_I2C_STATE, PL_REG_I2C_STATE_LEN);
+        return;
+    }
+    if (m_frame_state == PL_STATE_SOFT_RESET_CHECK)
+    {
+        if (!(m_buffer[0] & PL_REG_I2C_STATE_SOFT_RESET))
+        {
+            ifx_i2c_pl_frame_event_handler(IFX_I2C_PL_EVENT_ERROR);
+            return;
+        }
+        m_frame_state = PL_STATE_SOFT_RESET_WRITE;
+        ifx_i2c_pl_write_register(PL_REG_SOFT_RESET, sizeof(m_soft_reset), m_soft_reset);
+        return;
+    }
+    if (m_frame_state == PL_STATE_SOFT_RESET_WRITE)
+    {
+        // The device has been reset, continue with the frame size
+        ifx_i2c_pl_record_reset(0);
+        m_reset       = 1;
+        m_frame_state = PL_STATE_INIT;
     }
 
     if (m_frame_state == PL_STATE_INIT)
@@ -148,7 +199,8 @@ static void ifx_i2c_pl_frame_event_handler(uint8_t event)
     }
     else if (m_frame_state == PL_STATE_READY)
     {
-        // Start polling status register
+        // The frame size has been written to the device, start polling status register
+        m_negotiated             = 1;
         m_frame_state            = PL_STATE_POLL_STATUS;
         m_status_polling_counter = 0;
         ifx_i2c_pl_read_register(PL_REG_I2C_STATE, PL_REG_I2C_STATE_LEN);
@@ -160,7 +212,7 @@ static void ifx_i2c_pl_frame_event_handler(uint8_t event)
             && (m_buffer[0] & PL_REG_I2C_STATE_RESPONSE_READY))
         {
             frame_size = (m_buffer[2] << 8) | m_buffer[3];
-            if (frame_size > 0 && frame_size <= DL_MAX_FRAME_SIZE)
+            if (frame_size > 0 && frame_size <= m_frame_size)
             {
                 m_frame_state = PL_STATE_RXTX;
                 ifx_i2c_pl_read_register(PL_REG_DATA, frame_size);
@@ -211,7 +263,7 @@ static void ifx_i2c_hal_poll_callback(void)
     else if (m_i2c_cmd == PL_I2C_CMD_READ)
     {
         LOG_PL("[IFX-PL]: Timer -> Restart RX\n");
-        ifx_i2c_receive(m_buffer, m_buffer_tx_len);
+        ifx_i2c_receive(m_buffer, m_buffer_rx_len);
     }
 }
 
@@ -277,8 +329,25 @@ uint16_t ifx_i2c_pl_init(ifx_i2c_event_handler_t handler)
         return IFX_I2C_STACK_ERROR;
     }
 
-    // Set Physical Layer internal state
-    m_frame_state = PL_STATE_INIT;
+    // The register address and a frame must fit into one write of the I2C driver, the device
+    // is told the resulting frame size so it never sends a frame larger than one read either
+    m_frame_size = DL_MAX_FRAME_SIZE;
+    if (ifx_i2c_max_transfer() - 1 < m_frame_size)
+    {
+        m_frame_size = ifx_i2c_max_transfer() - 1;
+    }
+    if (m_frame_size < DL_HEADER_SIZE + 2)
+    {
+        return IFX_I2C_STACK_ERROR;
+    }
+    m_max_frame_size[0] = m_frame_size >> 8;
+    m_max_frame_size[1] = m_frame_size;
+    m_negotiated        = 0;
+    m_reset             = 0;
+
+    // Set Physical Layer internal state, the device is reset with the first frame
+    ifx_i2c_pl_record_reset(0);
+    m_frame_state = PL_STATE_SOFT_RESET;
 
     return IFX_I2C_STACK_SUCCESS;
 }
@@ -287,7 +356,7 @@ uint16_t ifx_i2c_pl_init(ifx_i2c_event_handler_t handler)
 uint16_t ifx_i2c_pl_send_frame(uint8_t* frame, uint16_t frame_len)
 {
     // Physical Layer must be idle, set requested action
-    if (m_frame_state != PL_STATE_INIT && m_frame_state != PL_STATE_READY)
+    if (m_frame_state != PL_STATE_SOFT_RESET && m_frame_state != PL_STATE_INIT && m_frame_state != PL_STATE_READY)
     {
         return IFX_I2C_STACK_ERROR;
     }
@@ -305,7 +374,7 @@ uint16_t ifx_i2c_pl_send_frame(uint8_t* frame, uint16_t frame_len)
 uint16_t ifx_i2c_pl_receive_frame(void)
 {
     // Physical Layer must be idle, set requested action
-    if (m_frame_state != PL_STATE_INIT && m_frame_state != PL_STATE_READY)
+    if (m_frame_state != PL_STATE_SOFT_RESET && m_frame_state != PL_STATE_INIT && m_frame_state != PL_STATE_READY)
     {
         return IFX_I2C_STACK_ERROR;
     }
@@ -314,3 +383,21 @@ uint16_t ifx_i2c_pl_receive_frame(void)
     ifx_i2c_pl_frame_event_handler(IFX_I2C_PL_EVENT_SUCCESS);
     return IFX_I2C_STACK_SUCCESS;
 }
+
+// Physical Layer high level interface function
+uint16_t ifx_i2c_pl_get_frame_size(void)
+{
+    return m_frame_size;
+}
+
+// Physical Layer high level interface function
+uint8_t ifx_i2c_pl_is_negotiated(void)
+{
+    return m_negotiated;
+}
+
+// Physical Layer high level interface function
+uint8_t ifx_i2c_pl_is_reset(void)
+{
+    return m_reset;
+}
@@ -94,6 +94,35 @@ uint16_t ifx_i2c_pl_send_frame(uint8_t* frame, uint16_t frame_len);
  */
 uint16_t ifx_i2c_pl_receive_frame(void);
 
+/**
+ * @brief Function for reading the frame size.
+ *
+ * The frame size is DL_MAX_FRAME_SIZE, or less if the I2C driver cannot transfer a complete
+ * frame at once. It is set by @ref ifx_i2c_pl_init and sent to the device with the first frame.
+ *
+ * @return  Maximum frame size in bytes, including the data link header.
+ */
+uint16_t ifx_i2c_pl_get_frame_size(void);
+
+/**
+ * @brief Function for checking whether the frame size has been sent to the device.
+ *
+ * @retval  1 If the frame size was written to the device since @ref ifx_i2c_pl_init.
+ * @retval  0 Otherwise.
+ */
+uint8_t ifx_i2c_pl_is_negotiated(void);
+
+/**
+ * @brief Function for checking whether the device has been soft reset.
+ *
+ * The first frame after @ref ifx_i2c_pl_init is preceded by a soft reset of the device.
+ * It is carried out with the transfers and timers of the frame, the function does not access the bus.
+ *
+ * @retval  1 If the soft reset was written to the device since @ref ifx_i2c_pl_init.
+ * @retval  0 Otherwise.
+ */
+uint8_t ifx_i2c_pl_is_reset(void);
+
 /**
  * @}
  **/
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// IFX I2C Protocol Stack - Record (source file)
+
+#include "ifx_i2c_record.h"
+
+#if IFX_I2C_RECORD
+
+#include "ifx_i2c_hal.h"
+#include <string.h> // memcpy
+
+// Type, two varints of at most 5 and 3 bytes
+#define RECORD_HEADER_MAX       9
+
+static ifx_i2c_record_writer_t m_writer;
+static uint32_t m_last_us;
+static uint8_t  m_first;
+static uint8_t  m_reset;
+
+// Appends a varint, returns the number of bytes
+static uint8_t ifx_i2c_record_varint(uint8_t* buffer, uint32_t value)
+{
+    uint8_t count = 0;
+
+    while (value >= 0x80)
+    {
+        buffer[count++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buffer[count++] = (uint8_t)value;
+    return count;
+}
+
+void ifx_i2c_record_start(ifx_i2c_record_writer_t writer)
+{
+    uint8_t header[IFX_I2C_RECORD_HEADER_LEN];
+    uint16_t max_transfer = ifx_i2c_max_transfer();
+
+    memcpy(header, IFX_I2C_RECORD_MAGIC, 4);
+    header[4] = IFX_I2C_RECORD_VERSION;
+    header[5] = (uint8_t)max_transfer;
+    header[6] = (uint8_t)(max_transfer >> 8);
+
+    m_writer = writer;
+    m_first = 1;
+    if (m_writer)
+    {
+        m_writer(header, sizeof(header));
+    }
+}
+
+void ifx_i2c_record_stop(void)
+{
+    m_writer = 0;
+}
+
+void ifx_i2c_record_reset(uint8_t active)
+{
+    m_reset = active;
+}
+
+void ifx_i2c_record_transfer(uint8_t type, const uint8_t* data, uint16_t length, uint32_t now_us)
+{
+    uint8_t header[RECORD_HEADER_MAX];
+    uint8_t header_len = 0;
+
+    if (!m_writer)
+    {
+        return;
+    }
+
+    header[header_len++] = m_reset ? (type | IFX_I2C_RECORD_RESET) : type;
+    header_len += ifx_i2c_record_varint(header + header_len, m_first ? 0 : now_us - m_last_us);
+    header_len += ifx_i2c_record_varint(header + header_len, length);
+    m_last_us = now_us;
+    m_first = 0;
+
+    m_writer(header, header_len);
+    if (length)
+    {
+        m_writer(data, length);
+    }
+}
+
+#endif /* IFX_I2C_RECORD */
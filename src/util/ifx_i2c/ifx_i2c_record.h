@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @defgroup ifx_i2c_record Infineon I2C Protocol Stack: Record and Replay
+ * @{
+ * @ingroup ifx_i2c
+ *
+ * @brief Module to record the I2C transactions of the HAL and to replay them without the device.
+ *
+ * With IFX_I2C_RECORD set to 1 the Arduino HAL passes every transaction to ifx_i2c_record_transfer(),
+ * which encodes it and hands it to a writer function of the application (e.g. a file on an SD card
+ * or the serial port). Recording has to be started before the stack is initialized, so the log
+ * begins with the soft reset.
+ *
+ * With IFX_I2C_HAL_REPLAY set to 1 the replay HAL is compiled instead of the Arduino HAL. It answers
+ * every read with the data of the log and checks every write against it, so a capture of a device
+ * can be run through a changed stack on any host, e.g. to compare CPU time and protocol round trips.
+ * The replay only holds as long as the stack issues the same transactions, the first difference is
+ * reported by ifx_i2c_replay_get_stats(). The RecordTransactions example records a log, extras/replay
+ * replays it on a host.
+ *
+ * Log format (multi-byte values are little endian, varint is 7 bits per byte, least significant first):
+ *  -# Header: IFX_I2C_RECORD_MAGIC (4 bytes), IFX_I2C_RECORD_VERSION (1 byte), ifx_i2c_max_transfer() (2 bytes)
+ *  -# One record per transaction: type (1 byte), time since the previous transaction in microseconds (varint),
+ *     length (varint), data. The data of a write starts with the register address. The data of a read are
+ *     the bytes received, a short read is recorded with the error flag.
+ */
+
+
+#ifndef IFX_I2C_RECORD_H__
+#define IFX_I2C_RECORD_H__
+
+
+#include "ifx_i2c_config.h"
+
+/** @brief First bytes of a log */
+#define IFX_I2C_RECORD_MAGIC        "I2CR"
+/** @brief Version of the log format */
+#define IFX_I2C_RECORD_VERSION      1
+/** @brief Length of the log header */
+#define IFX_I2C_RECORD_HEADER_LEN   7
+
+/** @brief Record type: the transaction is a read, a write otherwise */
+#define IFX_I2C_RECORD_READ         0x01
+/** @brief Record type: the transaction belongs to the soft reset before the first frame */
+#define IFX_I2C_RECORD_RESET        0x02
+/** @brief Record type: the transaction failed */
+#define IFX_I2C_RECORD_ERROR        0x80
+
+#if IFX_I2C_RECORD
+
+/**
+ * @brief Function pointer type for the writer of the log.
+ *
+ * Called with consecutive pieces of the log, it must store them before it returns.
+ */
+typedef void (*ifx_i2c_record_writer_t)(const uint8_t* data, uint16_t length);
+
+/**
+ * @brief Function for starting a recording, the log header is written immediately.
+ *
+ * @param[in] writer  Writer of the log.
+ */
+void ifx_i2c_record_start(ifx_i2c_record_writer_t writer);
+
+/**
+ * @brief Function for stopping the recording.
+ */
+void ifx_i2c_record_stop(void);
+
+/**
+ * @brief Function called by the physical layer before and after the soft reset of the device.
+ *
+ * The transactions in between are recorded with IFX_I2C_RECORD_RESET.
+ *
+ * @param[in] active  1 when the soft reset starts, 0 when it is done or failed.
+ */
+void ifx_i2c_record_reset(uint8_t active);
+
+/**
+ * @brief Function called by the HAL after each transaction.
+ *
+ * @param[in] type    IFX_I2C_RECORD_READ and IFX_I2C_RECORD_ERROR combined.
+ * @param[in] data    Data written or read.
+ * @param[in] length  Number of bytes written or read.
+ * @param[in] now_us  Time stamp of the HAL in microseconds.
+ */
+void ifx_i2c_record_transfer(uint8_t type, const uint8_t* data, uint16_t length, uint32_t now_us);
+
+#endif /* IFX_I2C_RECORD */
+
+#if IFX_I2C_HAL_REPLAY
+
+/** @brief Statistics of a replay */
+typedef struct
+{
+    uint32_t transactions;      /**< Transactions of the log replayed */
+    uint32_t mismatches;        /**< Transactions of the stack that differ from the log */
+    uint32_t first_mismatch;    /**< Number of the first transaction that differs, 0 if none */
+    uint32_t recorded_us;       /**< Time of the replayed transactions on the recording host */
+    uint32_t remaining;         /**< Bytes of the log not replayed */
+} ifx_i2c_replay_stats_t;
+
+/**
+ * @brief Function for starting a replay, called before the stack is initialized.
+ *
+ * @param[in] log     Recorded log, it is not copied and must stay valid during the replay.
+ * @param[in] length  Length of the log.
+ *
+ * @retval  IFX_I2C_STACK_SUCCESS if the log header is valid
+ * @retval  IFX_I2C_STACK_ERROR otherwise
+ */
+uint16_t ifx_i2c_replay_start(const uint8_t* log, uint32_t length);
+
+/**
+ * @brief Function for reading the statistics of the replay.
+ *
+ * @param[out] stats  Statistics.
+ */
+void ifx_i2c_replay_get_stats(ifx_i2c_replay_stats_t* stats);
+
+#endif /* IFX_I2C_HAL_REPLAY */
+
+#endif /* IFX_I2C_RECORD_H__ */
+
+/**
+ * @}
+ **/
@@ -42,6 +42,7 @@
 #define TL_STATE_IDLE                       0x01
 #define TL_STATE_TX                         0x02
 #define TL_STATE_RX                         0x04
+#define TL_STATE_RESYNC                     0x08
 
 // Transport Layer header size
 #define TL_HEADER_SIZE                      1
@@ -53,11 +54,24 @@
 #define TL_CHAINING_LAST                    0x04
 #define TL_CHAINING_ERROR                   0x07
 
-// Transport Layer state and buffer
+// Transport Layer state and receive buffer
 static volatile uint8_t  m_state = TL_STATE_UNINIT;
+#if IFX_I2C_TL_STREAMING == 0
 static          uint8_t  m_buffer[TL_BUFFER_SIZE];
+#endif
 static volatile uint16_t m_buffer_size;
-static volatile uint16_t m_buffer_pos;
+
+// Transmit packet, fragments are taken from the caller's buffer on demand
+static    const uint8_t* m_packet;
+static volatile uint16_t m_packet_len;
+static volatile uint16_t m_packet_pos;
+
+// Fragment being transmitted (the receive buffer is not in use while transmitting)
+#if IFX_I2C_TL_STREAMING == 0
+#define m_fragment m_buffer
+#else
+static          uint8_t  m_fragment[TL_MAX_FRAGMENT_SIZE];
+#endif
 
 // Upper layer event handler
 static volatile ifx_i2c_event_handler_t m_upper_layer_event_handler;
@@ -76,16 +90,37 @@ static volatile ifx_i2c_event_handler_t m_upper_layer_event_handler;
 // Internal helper function
 static uint16_t ifx_i2c_tl_send_next_fragment(void)
 {
-    // Calculate size of fragment (last one might be shorter)
-    uint16_t fragment_size = TL_MAX_FRAGMENT_SIZE;
-    if (m_buffer_pos + fragment_size > m_buffer_size)
+    // Calculate size of fragment payload (last one might be shorter)
+    uint16_t fragment_size = ifx_i2c_dl_get_max_payload() - TL_HEADER_SIZE;
+    if (m_packet_pos + fragment_size > m_packet_len)
+    {
+        fragment_size = m_packet_len - m_packet_pos;
+    }
+
+    // Fragment header with chaining information
+    if (fragment_size == m_packet_len)
+    {
+        m_fragment[0] = TL_CHAINING_NO;
+    }
+    else if (m_packet_pos == 0)
+    {
+        m_fragment[0] = TL_CHAINING_FIRST;
+    }
+    else if (m_packet_pos + fragment_size == m_packet_len)
     {
-        fragment_size = m_buffer_size - m_buffer_pos;
+        m_fragment[0] = TL_CHAINING_LAST;
     }
+    else
+    {
+        m_fragment[0] = TL_CHAINING_INTERMEDIATE;
+    }
+
+    // Fragment payload
+    memcpy(m_fragment + TL_HEADER_SIZE, m_packet + m_packet_pos, fragment_size);
 
-    // Shift buffer position for later use and start transmission
-    m_buffer_pos += fragment_size;
-    return ifx_i2c_dl_send_frame(m_buffer, fragment_size);
+    // Shift packet position for later use and start transmission
+    m_packet_pos += fragment_size;
+    return ifx_i2c_dl_send_frame(m_fragment, TL_HEADER_SIZE + fragment_size);
 }
 
 // Data Link layer event handler
@@ -94,6 +129,15 @@ static void ifx_i2c_dl_event_handler(uint8_t event, uint8_t* data, uint16_t data
     uint8_t pctr;
     uint8_t chaining;
 
+    // Re-synchronization of the Data Link layer complete, ready for the next packet
+    if (m_state == TL_STATE_RESYNC)
+    {
+        m_state = TL_STATE_IDLE;
+        m_upper_layer_event_handler((event & IFX_I2C_DL_EVENT_ERROR) ? IFX_I2C_TL_EVENT_ERROR
+                                    : IFX_I2C_TL_EVENT_SUCCESS, 0, 0);
+        return;
+    }
+
     // Propagate errors to upper layer
     if (event & IFX_I2C_DL_EVENT_ERROR)
     {
@@ -108,7 +152,7 @@ static void ifx_i2c_dl_event_handler(uint8_t event, uint8_t* data, uint16_t data
             TL_ERROR();
         }
 
-        if (m_buffer_pos < m_buffer_size)
+        if (m_packet_pos < m_packet_len)
         {
             // Transmission of one fragment complete, send next fragment
             LOG_TL("[IFX-TL]: TX Success -> send next\n");
@@ -164,11 +208,12 @@ static void ifx_i2c_dl_event_handler(uint8_t event, uint8_t* data, uint16_t data
 
         // When the received frame is not the last one, it must have the maximum allowed size
         if ((chaining == TL_CHAINING_FIRST || chaining == TL_CHAINING_INTERMEDIATE)
-            && data_len != TL_MAX_FRAGMENT_SIZE)
+            && data_len != ifx_i2c_dl_get_max_payload())
         {
             TL_ERROR();
         }
 
+#if IFX_I2C_TL_STREAMING == 0
         // Check for possible receive buffer overflow
         if (m_buffer_size + data_len - 1 > TL_BUFFER_SIZE)
         {
@@ -177,6 +222,10 @@ static void ifx_i2c_dl_event_handler(uint8_t event, uint8_t* data, uint16_t data
 
         // Copy frame payload to transport layer receive buffer
         memcpy(m_buffer + m_buffer_size, data + 1, data_len - 1);
+#else
+        // Hand frame payload over to the upper layer
+        m_upper_layer_event_handler(IFX_I2C_TL_EVENT_RX_FRAGMENT, data + 1, data_len - 1);
+#endif
         m_buffer_size += (data_len - 1);
 
         if (chaining == TL_CHAINING_NO || chaining == TL_CHAINING_LAST)
@@ -185,7 +234,11 @@ static void ifx_i2c_dl_event_handler(uint8_t event, uint8_t* data, uint16_t data
 
             // Inform upper layer that a packet has arrived
             m_state = TL_STATE_IDLE;
+#if IFX_I2C_TL_STREAMING == 0
             m_upper_layer_event_handler(IFX_I2C_TL_EVENT_SUCCESS, m_buffer, m_buffer_size);
+#else
+            m_upper_layer_event_handler(IFX_I2C_TL_EVENT_SUCCESS, 0, m_buffer_size);
+#endif
         }
         else
         { // IFX_I2C_TL_CHAINING_FIRST or IFX_I2C_TL_CHAINING_INTERMEDIATE
@@ -224,13 +277,8 @@ uint16_t ifx_i2c_tl_init(ifx_i2c_event_handler_t handler)
 }
 
 // Transport Layer transmit and receive function
-uint16_t ifx_i2c_tl_transceive(uint8_t* packet, uint16_t packet_len)
+uint16_t ifx_i2c_tl_transceive(const uint8_t* packet, uint16_t packet_len)
 {
-    uint16_t i;
-    uint16_t num_fragments;
-    uint16_t fragment_size;
-    uint16_t packet_pos = 0;
-
     LOG_TL("[IFX-TL]: Transceive txlen %d\n", packet_len);
 
     // Check function arguments
@@ -238,10 +286,6 @@ uint16_t ifx_i2c_tl_transceive(uint8_t* packet, uint16_t packet_len)
     {
         return IFX_I2C_STACK_ERROR;
     }
-    if (packet_len > TL_BUFFER_SIZE)
-    {
-        return IFX_I2C_STACK_ERROR;
-    }
 
     // Transport Layer must be idle
     if (m_state != TL_STATE_IDLE)
@@ -250,44 +294,32 @@ uint16_t ifx_i2c_tl_transceive(uint8_t* packet, uint16_t packet_len)
     }
     m_state = TL_STATE_TX;
 
-    // Reset buffer (optional)
-    memset(m_buffer, 0x00, sizeof(m_buffer));
-    m_buffer_size = m_buffer_pos = 0;
+    // The packet is fragmented while sending, it must stay valid until the transaction is complete
+    m_packet      = packet;
+    m_packet_len  = packet_len;
+    m_packet_pos  = 0;
+    m_buffer_size = 0;
 
-    // Fragment the packet in multiple frames and store all concatenated in the buffer
-    num_fragments = (packet_len + TL_MAX_FRAGMENT_SIZE - 1) / TL_MAX_FRAGMENT_SIZE;
-    for (i = 0; i < num_fragments; i++)
-    {
-        // Calculate size of fragment (last one might be shorter)
-        fragment_size = TL_MAX_FRAGMENT_SIZE - TL_HEADER_SIZE;
-        if (packet_pos + fragment_size > packet_len)
-        {
-            fragment_size = packet_len - packet_pos;
-        }
+    return ifx_i2c_tl_send_next_fragment();
+}
 
-        // Append fragment header with chaining information
-        if (num_fragments == 1)
-        {
-            m_buffer[m_buffer_size++] = TL_CHAINING_NO;
-        }
-        else if (i == 0)
-        {
-            m_buffer[m_buffer_size++] = TL_CHAINING_FIRST;
-        }
-        else if (i == (num_fragments - 1))
-        {
-            m_buffer[m_buffer_size++] = TL_CHAINING_LAST;
-        }
-        else
-        {
-            m_buffer[m_buffer_size++] = TL_CHAINING_INTERMEDIATE;
-        }
+// Transport Layer re-synchronization function
+uint16_t ifx_i2c_tl_resync(void)
+{
+    LOG_TL("[IFX-TL]: Re-synchronize\n");
 
-        // Append fragment payload
-        memcpy(m_buffer + m_buffer_size, packet + packet_pos, fragment_size);
-        packet_pos    += fragment_size;
-        m_buffer_size += fragment_size;
+    // Allowed in any state after initialization, a failed transaction leaves the state unchanged
+    if (m_state == TL_STATE_UNINIT)
+    {
+        return IFX_I2C_STACK_ERROR;
     }
+    m_state       = TL_STATE_RESYNC;
+    m_buffer_size = 0;
 
-    return ifx_i2c_tl_send_next_fragment();
+    if (ifx_i2c_dl_resync())
+    {
+        m_state = TL_STATE_IDLE;
+        return IFX_I2C_STACK_ERROR;
+    }
+    return IFX_I2C_STACK_SUCCESS;
 }
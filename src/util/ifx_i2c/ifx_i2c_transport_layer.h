@@ -50,6 +50,8 @@
 #define IFX_I2C_TL_EVENT_ERROR              0x01
 /** @brief Success event propagated to upper layer */
 #define IFX_I2C_TL_EVENT_SUCCESS            0x02
+/** @brief Received fragment propagated to upper layer (only if IFX_I2C_TL_STREAMING is set) */
+#define IFX_I2C_TL_EVENT_RX_FRAGMENT        0x04
 
 /**
  * @brief Function for initializing the module.
@@ -72,13 +74,33 @@ uint16_t ifx_i2c_tl_init(ifx_i2c_event_handler_t handler);
  * The function returns immediately. One of the following events is
  * propagated to the event handler registered with @ref ifx_i2c_tl_init
  *
+ * The packet is fragmented while it is sent and must stay valid until the
+ * transaction is complete.
+ *
+ * If IFX_I2C_TL_STREAMING is set, the response is not reassembled. Instead each
+ * received fragment is propagated with IFX_I2C_TL_EVENT_RX_FRAGMENT and the final
+ * IFX_I2C_TL_EVENT_SUCCESS carries no data but the total response length.
+ *
  * @param[in] packet         Buffer containing the packet.
  * @param[in] packet_len     Frame length.
  *
  * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
  * @retval  IFX_I2C_STACK_ERROR If the module is busy.
  */
-uint16_t ifx_i2c_tl_transceive(uint8_t* packet, uint16_t packet_len);
+uint16_t ifx_i2c_tl_transceive(const uint8_t* packet, uint16_t packet_len);
+
+/**
+ * @brief Function to re-synchronize the link after a failed transaction.
+ *
+ * Asynchronous function that discards a partially transferred packet and resets the
+ * frame counters of the data link layer on both sides without resetting the device.
+ * IFX_I2C_TL_EVENT_SUCCESS or IFX_I2C_TL_EVENT_ERROR is propagated to the event handler
+ * registered with @ref ifx_i2c_tl_init.
+ *
+ * @retval  IFX_I2C_STACK_SUCCESS If function was successful.
+ * @retval  IFX_I2C_STACK_ERROR If the module is not initialized or the lower layers are busy.
+ */
+uint16_t ifx_i2c_tl_resync(void);
 
 /**
  * @}
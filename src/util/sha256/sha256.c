@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// SHA-256 (source file)
+
+#include "sha256.h"
+#include <string.h> // memcpy, memset
+
+#define ROTR(x, n)      (((x) >> (n)) | ((x) << (32 - (n))))
+
+static const uint32_t m_k[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+// Processes one block, the message schedule is kept as a rolling window of 16 words
+static void sha256_block(sha256_context_t* context)
+{
+    uint32_t w[16];
+    uint32_t s[8];
+    uint32_t t1, t2;
+    uint8_t  i;
+
+    for (i = 0; i < 16; i++)
+    {
+        w[i] = ((uint32_t)context->block[4 * i] << 24) | ((uint32_t)context->block[4 * i + 1] << 16)
+             | ((uint32_t)context->block[4 * i + 2] << 8) | context->block[4 * i + 3];
+    }
+    memcpy(s, context->state, sizeof(s));
+
+    for (i = 0; i < 64; i++)
+    {
+        if (i >= 16)
+        {
+            t1 = w[(i + 1) & 15];
+            t2 = w[(i + 14) & 15];
+            w[i & 15] += (ROTR(t1, 7) ^ ROTR(t1, 18) ^ (t1 >> 3)) + w[(i + 9) & 15]
+                       + (ROTR(t2, 17) ^ ROTR(t2, 19) ^ (t2 >> 10));
+        }
+        t1 = s[7] + (ROTR(s[4], 6) ^ ROTR(s[4], 11) ^ ROTR(s[4], 25)) + ((s[4] & s[5]) ^ (~s[4] & s[6]))
+           + m_k[i] + w[i & 15];
+        t2 = (ROTR(s[0], 2) ^ ROTR(s[0], 13) ^ ROTR(s[0], 22)) + ((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+        memmove(s + 1, s, 7 * sizeof(uint32_t));
+        s[4] += t1;
+        s[0] = t1 + t2;
+    }
+
+    for (i = 0; i < 8; i++)
+    {
+        context->state[i] += s[i];
+    }
+}
+
+void sha256_init(sha256_context_t* context)
+{
+    static const uint32_t initial[8] =
+    {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    memcpy(context->state, initial, sizeof(initial));
+    context->length = 0;
+}
+
+void sha256_update(sha256_context_t* context, const uint8_t* data, uint32_t length)
+{
+    uint8_t used;
+    uint8_t copy;
+
+    while (length > 0)
+    {
+        used = context->length & 63;
+        copy = (length < (uint32_t)(64 - used)) ? (uint8_t)length : 64 - used;
+        memcpy(context->block + used, data, copy);
+        context->length += copy;
+        data += copy;
+        length -= copy;
+        if ((context->length & 63) == 0)
+        {
+            sha256_block(context);
+        }
+    }
+}
+
+void sha256_final(sha256_context_t* context, uint8_t* digest)
+{
+    uint8_t  used = context->length & 63;
+    uint32_t bits = context->length << 3;
+    uint8_t  i;
+
+    // Padding: 0x80, zeros and the message length in bits (big endian, 64 bit)
+    context->block[used++] = 0x80;
+    if (used > 56)
+    {
+        memset(context->block + used, 0, 64 - used);
+        sha256_block(context);
+        used = 0;
+    }
+    memset(context->block + used, 0, 64 - used);
+    context->block[59] = context->length >> 29;
+    context->block[60] = bits >> 24;
+    context->block[61] = bits >> 16;
+    context->block[62] = bits >> 8;
+    context->block[63] = bits;
+    sha256_block(context);
+
+    for (i = 0; i < SHA256_DIGEST_LEN; i++)
+    {
+        digest[i] = context->state[i >> 2] >> (24 - 8 * (i & 3));
+    }
+}
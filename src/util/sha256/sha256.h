@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2017, Infineon Technologies AG
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software
+ *     without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @defgroup sha256 SHA-256
+ * @{
+ * @ingroup ifx_optiga
+ *
+ * @brief Compact SHA-256 (FIPS 180-4) used to hash certificates for their validation.
+ *
+ * The context holds one block, data can be added in pieces of any size.
+ */
+
+
+#ifndef SHA256_H__
+#define SHA256_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Length of a SHA-256 digest in bytes */
+#define SHA256_DIGEST_LEN   32
+
+/** @brief Hash context */
+typedef struct
+{
+    uint32_t state[8];      /**< Intermediate hash value */
+    uint32_t length;        /**< Number of bytes added so far */
+    uint8_t  block[64];     /**< Bytes not yet processed */
+} sha256_context_t;
+
+/**
+ * @brief Starts a new hash.
+ *
+ * @param[out] context      Hash context.
+ */
+void sha256_init(sha256_context_t* context);
+
+/**
+ * @brief Adds data to the hash.
+ *
+ * @param[in,out] context   Hash context.
+ * @param[in]     data      Data to add.
+ * @param[in]     length    Length of the data.
+ */
+void sha256_update(sha256_context_t* context, const uint8_t* data, uint32_t length);
+
+/**
+ * @brief Finishes the hash, the context must be initialized again before it is reused.
+ *
+ * @param[in,out] context   Hash context.
+ * @param[out]    digest    SHA256_DIGEST_LEN bytes.
+ */
+void sha256_final(sha256_context_t* context, uint8_t* digest);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHA256_H__ */
+
+/**
+ * @}
+ **/